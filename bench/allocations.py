@@ -0,0 +1,54 @@
+# Heap bytes allocated by `_ROUNDS` readblocks/writeblocks calls of the pure Python SDObject in sdcard.py ~ steady state should be 0.
+# Run on stock rp2 firmware with sdcard.py on the board. Both the bytecode and the sdfast.py path (when present) are checked.
+# Block `_START` onward is overwritten ~ use a scratch card. Exits with status 1 when any call allocated.
+import sdcard, gc, sys
+from machine import Pin, SPI
+
+_SPI    = const(1)
+_SCK    = const(10)
+_MOSI   = const(11)
+_MISO   = const(8)
+_CS     = const(9)
+_BAUD   = const(12500000)
+
+_START  = const(0x10000)
+_ROUNDS = const(16)
+
+COUNTS  = (1, 8, 32)            #blocks per call ~ 1 is CMD17/CMD24
+
+#the first call on a buffer builds its block views ~ only the calls after it are counted, all of them together so a few bytes can't round away
+def allocated(fn, buf:bytearray) -> int:
+    fn(_START, buf)
+    gc.collect()
+    gc.disable()
+    before = gc.mem_alloc()
+    for i in range(_ROUNDS):
+        fn(_START, buf)
+    after = gc.mem_alloc()
+    gc.enable()
+    return after - before
+
+def main() -> None:
+    spi   = SPI(_SPI, sck=Pin(_SCK), mosi=Pin(_MOSI), miso=Pin(_MISO))
+    sd    = sdcard.SDObject(spi, Pin(_CS, Pin.OUT), _BAUD)
+    units = (-1, sd.unit) if sd.unit > -1 else (-1,)
+    worst = 0
+
+    print('bytes allocated by {} calls'.format(_ROUNDS))
+    print('{:>8} {:>6} {:>6} {:>6}'.format('path', 'blocks', 'read', 'write'))
+    for unit in units:
+        sd.unit = unit
+        for nblocks in COUNTS:
+            buf = bytearray(nblocks * 0x200)
+            rd  = allocated(sd.readblocks, buf)
+            wr  = allocated(sd.writeblocks, buf)
+            worst = max(worst, rd, wr)
+            print('{:>8} {:>6} {:>6} {:>6}'.format('viper' if unit > -1 else 'bytecode', nblocks, rd, wr))
+            buf = None
+            gc.collect()
+
+    if worst:
+        print('allocations in steady-state block I/O', file=sys.stderr)
+        sys.exit(1)
+
+main()
@@ -0,0 +1,59 @@
+# Latency seen by a periodic uasyncio task while another task writes to the card, blocking writeblocks versus awaitable awriteblocks.
+# Run on the board with the sdcard C module compiled in. Adjust the pins to your wiring.
+# Block `_START` onward is overwritten ~ use a scratch card.
+import sdcard, utime, uasyncio
+from machine import Pin, SPI
+
+_SPI     = const(1)
+_SCK     = const(10)
+_MOSI    = const(11)
+_MISO    = const(8)
+_CS      = const(9)
+_BAUD    = const(25000000)
+
+_START   = const(0x10000)
+_TOTAL   = const(0x100000)   #1 MB written per measurement
+_CHUNK   = const(0x2000)     #8 KB per call
+_PERIOD  = const(5)          #ms between sensor samples
+
+# wakes every _PERIOD ms and records how late each wake-up was
+async def sensor(late:list, done:list) -> None:
+    due = utime.ticks_add(utime.ticks_ms(), _PERIOD)
+    while not done[0]:
+        await uasyncio.sleep_ms(max(0, utime.ticks_diff(due, utime.ticks_ms())))
+        late.append(max(0, utime.ticks_diff(utime.ticks_ms(), due)))
+        due = utime.ticks_add(due, _PERIOD)
+
+async def writer(sd, buf:bytearray, awaitable:bool, done:list) -> None:
+    nblocks = len(buf) // 0x200
+    for i in range(_TOTAL // len(buf)):
+        if awaitable:
+            await sd.awriteblocks(_START + i * nblocks, buf)
+        else:
+            sd.writeblocks(_START + i * nblocks, buf)
+            await uasyncio.sleep_ms(0)
+    done[0] = True
+
+async def measure(sd, buf:bytearray, awaitable:bool) -> tuple:
+    late, done = [], [False]
+    t = utime.ticks_us()
+    task = uasyncio.create_task(sensor(late, done))
+    await writer(sd, buf, awaitable, done)
+    us = utime.ticks_diff(utime.ticks_us(), t)
+    await task
+    mean = sum(late) / len(late) if late else 0.0
+    return max(late) if late else 0, mean, _TOTAL / us if us else 0.0
+
+async def run(sd) -> None:
+    buf = bytearray(_CHUNK)
+    print('{:>10} {:>12} {:>12} {:>8}'.format('mode', 'max late ms', 'mean late ms', 'MB/s'))
+    for name, awaitable in (('blocking', False), ('awaitable', True)):
+        worst, mean, rate = await measure(sd, buf, awaitable)
+        print('{:>10} {:>12} {:>12.2f} {:>8.2f}'.format(name, worst, mean, rate))
+
+def main() -> None:
+    SPI(_SPI, sck=Pin(_SCK), mosi=Pin(_MOSI), miso=Pin(_MISO))
+    sd = sdcard.SDObject(_SPI, _CS, _BAUD)
+    uasyncio.run(run(sd))
+
+main()
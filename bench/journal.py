@@ -0,0 +1,46 @@
+# Append rate and head recovery time of sdjournal.Journal over the whole card past `_START`.
+# Run on the board with the sdcard C module compiled in and sdjournal.py next to it. Adjust the pins to your wiring.
+# Blocks `_START` onward are overwritten ~ use a scratch card.
+import sdcard, sdjournal, utime
+from machine import Pin, SPI
+
+_SPI     = const(1)
+_SCK     = const(10)
+_MOSI    = const(11)
+_MISO    = const(8)
+_CS      = const(9)
+_BAUD    = const(25000000)
+
+_START   = const(0x10000)
+_RECORDS = const(2000)
+_SIZES   = (16, 128, 496)       #record bytes ~ 496 fills a block
+
+def main() -> None:
+    SPI(_SPI, sck=Pin(_SCK), mosi=Pin(_MOSI), miso=Pin(_MISO))
+    sd    = sdcard.SDObject(_SPI, _CS, _BAUD)
+    count = sd.sectors - _START
+    
+    j = sdjournal.Journal(sd, _START, count)
+    j.reset()
+    print('region {} blocks ({} MB)'.format(count, count >> 11))
+    print('{:>6} {:>10} {:>10}'.format('bytes', 'records/s', 'us/record'))
+    for size in _SIZES:
+        rec = bytes(size)
+        t   = utime.ticks_us()
+        for i in range(_RECORDS):
+            j.append(rec)
+        us  = utime.ticks_diff(utime.ticks_us(), t)
+        print('{:>6} {:>10.0f} {:>10.0f}'.format(size, _RECORDS * 1e6 / us, us / _RECORDS))
+    
+    #a fresh Journal recovers from the card alone, as after a power cut
+    t = utime.ticks_us()
+    j2 = sdjournal.Journal(sd, _START, count)
+    us = utime.ticks_diff(utime.ticks_us(), t)
+    print('recover: head {} ({}) in {:.2f} ms, {} blocks read'.format(j2.seq - 1, 'ok' if j2.seq == j.seq else 'WRONG', us / 1000, j2.reads))
+    
+    n = 0
+    for seq, rec in j2.iter_from(j2.seq - 64):
+        n += 1
+    print('iter_from: last {} records read back'.format(n))
+
+main()
@@ -0,0 +1,86 @@
+# Raw region logging with SDObject.logger(): flat-out append rate against the bus, then a paced 200 kHz 16-bit capture.
+# Run on the board with the sdcard C module compiled in and sdlog.py next to it. Adjust the pins to your wiring.
+# Blocks `_START` to `_START + _REGION` are overwritten ~ use a scratch card.
+import sdcard, sdlog, utime, gc
+from machine import Pin, SPI
+
+_SPI     = const(1)
+_SCK     = const(10)
+_MOSI    = const(11)
+_MISO    = const(8)
+_CS      = const(9)
+_BAUD    = const(25000000)
+
+_START   = const(0x10000)
+_REGION  = const(0x1000)        #2 MB ~ small enough that the flat-out pass wraps
+_BLOCKS  = const(0x1800)        #blocks appended per pass
+_RATE    = const(400000)        #200 kHz of 16-bit samples in bytes per second
+_RING    = (4, 16, 64)
+
+def mbps(nbytes:int, us:int) -> float:
+    return nbytes / us if us else 0.0   #bytes per us == MB/s
+
+#every block carries its sequence number so the read back can check order and gaps
+def stamp(buf:bytearray, n:int) -> None:
+    buf[0], buf[1], buf[2], buf[3] = n & 0xFF, (n >> 8) & 0xFF, (n >> 16) & 0xFF, n >> 24
+
+def flat(sd, ring:int) -> dict:
+    buf = bytearray(0x200)
+    log = sd.logger(_START, _REGION, ring=ring)
+    t   = utime.ticks_us()
+    for n in range(_BLOCKS):
+        #waits for room instead of dropping ~ this pass measures the card, not the producer
+        while log.pump() >= ring:
+            pass
+        stamp(buf, n)
+        log.append(buf)
+    log.flush()
+    us   = utime.ticks_diff(utime.ticks_us(), t)
+    info = log.info()
+    log.close()
+    info['mb_s'] = mbps(info['appended'] * 0x200, us)
+    return info
+
+#one block is due every 512 / _RATE seconds ~ late ones are appended as soon as the loop gets to them
+def paced(sd, ring:int) -> dict:
+    buf  = bytearray(0x200)
+    log  = sd.logger(_START, _REGION, ring=ring)
+    step = 0x200 * 1000000 // _RATE
+    due  = utime.ticks_us()
+    for n in range(_BLOCKS):
+        while utime.ticks_diff(utime.ticks_us(), due) < 0:
+            log.pump()
+        stamp(buf, n)
+        log.append(buf)
+        due = utime.ticks_add(due, step)
+    log.flush()
+    info = log.info()
+    log.close()
+    return info
+
+#blocks read back in write order should count up ~ returns how many broke the sequence
+def check(sd, info:dict) -> int:
+    bad, last = 0, None
+    for block in sdlog.scan(sd, _START, _REGION, info['position'], info['wraps']):
+        n = block[0] | block[1] << 8 | block[2] << 16 | block[3] << 24
+        if last is not None and n != last + 1:
+            bad += 1
+        last = n
+    return bad
+
+def main() -> None:
+    SPI(_SPI, sck=Pin(_SCK), mosi=Pin(_MOSI), miso=Pin(_MISO))
+    sd  = sdcard.SDObject(_SPI, _CS, _BAUD)
+    bus = sd.baudrate / 8e6
+    
+    print('bus {:.2f} MB/s, capture {:.2f} MB/s'.format(bus, _RATE / 1e6))
+    print('{:>6} {:>6} {:>8} {:>6} {:>8} {:>8} {:>6} {:>10} {:>6}'.format('pass', 'ring', 'MB/s', 'of bus', 'dropped', 'overruns', 'high', 'max busy', 'gaps'))
+    for ring in _RING:
+        for name, fn in (('flat', flat), ('paced', paced)):
+            info = fn(sd, ring)
+            mb   = info.get('mb_s', _RATE / 1e6)
+            print('{:>6} {:>6} {:>8.2f} {:>6.2f} {:>8} {:>8} {:>6} {:>10} {:>6}'.format(
+                name, ring, mb, mb / bus, info['dropped'], info['overruns'], info['high_water'], info['max_busy_us'], check(sd, info)))
+            gc.collect()
+
+main()
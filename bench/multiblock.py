@@ -0,0 +1,51 @@
+# Multi-block write throughput with CMD23-bounded runs versus open-ended runs (ACMD23 pre-erase + stop token).
+# Run on the board with the sdcard C module compiled in. Adjust the pins to your wiring.
+# Block `_START` onward is overwritten ~ use a scratch card.
+import sdcard, utime, gc
+from machine import Pin, SPI
+
+_SPI    = const(1)
+_SCK    = const(10)
+_MOSI   = const(11)
+_MISO   = const(8)
+_CS     = const(9)
+_BAUD   = const(25000000)
+
+_START  = const(0x10000)
+_TOTAL  = const(0x100000)   #1 MB written per measurement
+
+SIZES   = (0x8000, 0x10000, 0x20000, 0x40000, 0x80000, 0x100000)
+
+def measure(sd, buf:bytearray) -> float:
+    nblocks = len(buf) // 0x200
+    calls   = max(1, _TOTAL // len(buf))
+    t = utime.ticks_us()
+    for i in range(calls):
+        sd.writeblocks(_START + i * nblocks, buf)
+    us = utime.ticks_diff(utime.ticks_us(), t)
+    return (len(buf) * calls) / us if us else 0.0
+
+def main() -> None:
+    SPI(_SPI, sck=Pin(_SCK), mosi=Pin(_MOSI), miso=Pin(_MISO))
+    sd = sdcard.SDObject(_SPI, _CS, _BAUD)
+    supported = sd.cmd23
+    print('card advertises CMD23:', supported)
+    
+    print('{:>8} {:>10} {:>10} {:>6}'.format('size', 'open MB/s', 'cmd23 MB/s', 'gain'))
+    for size in SIZES:
+        gc.collect()
+        try:
+            buf = bytearray(size)
+        except MemoryError:
+            print('{:>8} does not fit in RAM'.format(size))
+            continue
+            
+        sd.cmd23 = False
+        open_run = measure(sd, buf)
+        sd.cmd23 = True
+        bounded  = measure(sd, buf) if supported else 0.0
+        gain     = '{:.2f}x'.format(bounded / open_run) if (supported and open_run) else '-'
+        print('{:>8} {:>10.2f} {:>10.2f} {:>6}'.format(size, open_run, bounded, gain))
+        buf = None
+
+main()
@@ -0,0 +1,121 @@
+# Protocol cost of SDObject block transfers against the simulated card, as JSON.
+# Run in the unix port built with the sdcard module (see modules/ in the README): micropython protocol.py [baseline.json]
+# Per case: bus bytes per payload byte, commands/CMD12/stop tokens per MB, host CPU us per block and MB/s on the virtual bus clock.
+# With a baseline (a saved earlier run) the deterministic figures are compared and any regression exits with status 1.
+import sdcard, time, json, sys
+
+_SPI     = const(0)
+_CS      = const(17)
+_BAUD    = const(25000000)
+_MB      = const(64)            #card size
+_TOTAL   = const(0x100000)      #payload moved per case
+_SLACK   = 0.01                 #relative change a baseline comparison lets through
+
+COUNTS   = (1, 2, 8, 32, 128)   #blocks per call ~ 1 is CMD17/CMD24
+RECORDS  = const(40)            #single-block buffers per readv/writev call ~ drawn in clusters of up to 4 neighbours
+
+#lower is better except MB/s ~ CPU time is left out because it depends on the host
+TRACKED  = (('bus_bytes_per_byte', 1), ('cmds_per_mb', 1), ('cmd12_per_mb', 1), ('stop_tran_per_mb', 1), ('mb_s', -1))
+
+class Lcg:
+    #same addresses on every run so results stay comparable
+    def __init__(self, seed:int=1) -> None:
+        self.state = seed
+
+    def below(self, n:int) -> int:
+        self.state = (self.state * 1103515245 + 12345) & 0x7FFFFFFF
+        return self.state % n
+
+#scattered records ~ what an index lookup asks for
+def requests(rng, bufs:list) -> list:
+    reqs  = []
+    block = 0
+    for i, buf in enumerate(bufs):
+        block = block + 1 if i % 4 and rng.below(2) else rng.below(_MB * 2048 - 4)
+        reqs.append((block, buf))
+    return reqs
+
+def case(sd, op:str, nblocks:int, random:bool, cmd23:bool) -> dict:
+    vector = op in ('readv', 'writev')
+    bufs   = [bytearray(0x200) for i in range(RECORDS)] if vector else None
+    buf    = bytearray(RECORDS * 0x200 if vector else nblocks * 0x200)
+    calls  = _TOTAL // len(buf)
+    span   = (_MB * 2048) - nblocks
+    rng    = Lcg()
+    fn     = {'write': sd.writeblocks, 'read': sd.readblocks, 'writev': sd.writev, 'readv': sd.readv}[op]
+    sd.cmd23 = cmd23
+
+    sdcard.sim_info(_SPI, True)
+    bus0 = sdcard.sim_info(_SPI)['time_us']
+    t = time.ticks_us()
+    for i in range(calls):
+        if vector:
+            fn(requests(rng, bufs))
+        else:
+            fn(rng.below(span) if random else i * nblocks, buf)
+    cpu  = time.ticks_diff(time.ticks_us(), t)
+    info = sdcard.sim_info(_SPI)
+
+    payload = len(buf) * calls
+    mb      = payload / 0x100000
+    cmds    = info['commands']
+    bus_us  = info['time_us'] - bus0
+    return {
+        'op'                 : op,
+        'pattern'            : 'scattered' if vector else 'random' if random else 'sequential',
+        'blocks'             : nblocks,
+        'cmd23'              : cmd23,
+        'calls'              : calls,
+        'payload'            : payload,
+        'bus_bytes_per_byte' : round(info['bytes'] / payload, 4),
+        'cmds_per_mb'        : round(sum(cmds.values()) / mb, 2),
+        'cmd12_per_mb'       : round(cmds.get(12, 0) / mb, 2),
+        'stop_tran_per_mb'   : round(info['stop_tran'] / mb, 2),
+        'cpu_us_per_block'   : round(cpu / (payload // 0x200), 2),
+        'mb_s'               : round(payload / bus_us, 3) if bus_us else 0.0,
+    }
+
+def key(r:dict) -> str:
+    return '{} {} {} {}'.format(r['op'], r['pattern'], r['blocks'], 'cmd23' if r['cmd23'] else 'open')
+
+def compare(results:list, path:str) -> list:
+    with open(path) as f:
+        base = {key(r): r for r in json.load(f)['results']}
+
+    worse = []
+    for r in results:
+        b = base.get(key(r))
+        if b is None:
+            continue
+        for name, sign in TRACKED:
+            was, now = b[name], r[name]
+            if (now - was) * sign > abs(was) * _SLACK:
+                worse.append('{}: {} {} -> {}'.format(key(r), name, was, now))
+    return worse
+
+def main() -> None:
+    sdcard.sim(_SPI, _CS, mb=_MB)
+    sd = sdcard.SDObject(_SPI, _CS, _BAUD)
+
+    results = []
+    for op in ('write', 'read'):
+        for nblocks in COUNTS:
+            for random in (False, True):
+                #CMD23 only changes multi-block runs
+                for cmd23 in ((False, True) if nblocks > 1 else (False,)):
+                    results.append(case(sd, op, nblocks, random, cmd23))
+    #40 scattered records per call ~ set against the random single-block cases above
+    for op in ('writev', 'readv'):
+        for cmd23 in (False, True):
+            results.append(case(sd, op, 1, True, cmd23))
+
+    print(json.dumps({'baudrate': sd.baudrate, 'total': _TOTAL, 'results': results}))
+
+    if len(sys.argv) > 1:
+        worse = compare(results, sys.argv[1])
+        for line in worse:
+            print('regression', line, file=sys.stderr)
+        if worse:
+            sys.exit(1)
+
+main()
@@ -0,0 +1,75 @@
+# Block throughput of the pure Python SDObject in sdcard.py, bytecode against the viper fast path in sdfast.py.
+# Run on stock rp2 firmware with sdcard.py (or sdcard.mpy) and sdfast.py on the board. Adjust the pins to your wiring.
+# Block `_START` onward is overwritten ~ use a scratch card.
+import sdcard, utime, gc
+from machine import Pin, SPI
+
+_SPI    = const(1)
+_SCK    = const(10)
+_MOSI   = const(11)
+_MISO   = const(8)
+_CS     = const(9)
+
+_START  = const(0x10000)
+_ROUNDS = const(8)
+
+RATES   = (5000000, 12500000, 25000000)
+COUNTS  = (1, 8, 32)            #blocks per call ~ 1 is CMD17/CMD24
+
+def mbps(nbytes:int, us:int) -> float:
+    return nbytes / us if us else 0.0   #bytes per us == MB/s
+
+def run(fn, buf:bytearray, nblocks:int) -> float:
+    t = utime.ticks_us()
+    for i in range(_ROUNDS):
+        fn(_START + i * nblocks, buf)
+    return mbps(len(buf) * _ROUNDS, utime.ticks_diff(utime.ticks_us(), t))
+
+#what one path wrote the other reads back the same
+def check(sd, unit:int, buf:bytearray) -> bool:
+    back = bytearray(len(buf))
+    for i in range(len(buf)):
+        buf[i] = (i * 7 + 3) & 0xFF
+    sd.unit = unit
+    sd.writeblocks(_START, buf)
+    sd.unit = -1
+    sd.readblocks(_START, back)
+    sd.unit = unit
+    return back == buf
+
+def main() -> None:
+    if sdcard.sdfast is None:
+        print('sdfast unavailable ~ nothing to compare')
+        return
+
+    spi = SPI(_SPI, sck=Pin(_SCK), mosi=Pin(_MOSI), miso=Pin(_MISO))
+    cs  = Pin(_CS, Pin.OUT)
+
+    print('{:>10} {:>6} {:>8} {:>8} {:>8} {:>8} {:>6} {:>6}'.format('rate', 'blocks', 'rd byte', 'rd viper', 'wr byte', 'wr viper', 'rd x', 'wr x'))
+    for rate in RATES:
+        sd   = sdcard.SDObject(spi, cs, rate)
+        unit = sd.unit
+        if unit < 0:
+            print('SPI{} is not a hardware unit on this port'.format(_SPI))
+            return
+
+        for nblocks in COUNTS:
+            buf = bytearray(nblocks * 0x200)
+            if not check(sd, unit, buf):
+                print('data mismatch at {} blocks, {} Hz'.format(nblocks, rate))
+                return
+
+            sd.unit = -1
+            rd0 = run(sd.readblocks, buf, nblocks)
+            wr0 = run(sd.writeblocks, buf, nblocks)
+            sd.unit = unit
+            rd1 = run(sd.readblocks, buf, nblocks)
+            wr1 = run(sd.writeblocks, buf, nblocks)
+
+            print('{:>10} {:>6} {:>8.3f} {:>8.3f} {:>8.3f} {:>8.3f} {:>6.2f} {:>6.2f}'.format(
+                rate, nblocks, rd0, rd1, wr0, wr1, rd1 / rd0 if rd0 else 0.0, wr1 / wr0 if wr0 else 0.0))
+            buf = None
+            gc.collect()
+        sd = None
+
+main()
@@ -0,0 +1,44 @@
+# Block throughput of the C module's SDObject across SPI clocks, with and without DMA.
+# Run on the board with the sdcard C module compiled in. Adjust the pins to your wiring.
+# Block `_START` onward is overwritten ~ use a scratch card.
+import sdcard, utime, gc
+from machine import Pin, SPI
+
+_SPI    = const(1)
+_SCK    = const(10)
+_MOSI   = const(11)
+_MISO   = const(8)
+_CS     = const(9)
+
+_START  = const(0x10000)
+_BLOCKS = const(128)        #64 KB per call
+_ROUNDS = const(8)
+
+RATES   = (5000000, 12500000, 25000000, 31250000)
+
+def mbps(nbytes:int, us:int) -> float:
+    return nbytes / us if us else 0.0   #bytes per us == MB/s
+
+def run(fn, buf:bytearray) -> float:
+    t = utime.ticks_us()
+    for i in range(_ROUNDS):
+        fn(_START + i * _BLOCKS, buf)
+    return mbps(len(buf) * _ROUNDS, utime.ticks_diff(utime.ticks_us(), t))
+
+def main() -> None:
+    #let machine.SPI route the pins, then hand the peripheral to the driver
+    SPI(_SPI, sck=Pin(_SCK), mosi=Pin(_MOSI), miso=Pin(_MISO))
+    buf = bytearray(_BLOCKS * 0x200)
+    
+    print('{:>10} {:>10} {:>5} {:>8} {:>8} {:>8}'.format('requested', 'actual', 'dma', 'bus', 'read', 'write'))
+    for rate in RATES:
+        for dma in (False, True):
+            sd   = sdcard.SDObject(_SPI, _CS, rate, -1, dma)
+            bus  = sd.baudrate / 8e6
+            wr   = run(sd.writeblocks, buf)
+            rd   = run(sd.readblocks, buf)
+            print('{:>10} {:>10} {:>5} {:>8.2f} {:>8.2f} {:>8.2f}'.format(rate, sd.baudrate, sd.dma, bus, rd, wr))
+            sd = None
+            gc.collect()    #releases the DMA channels through __del__
+
+main()
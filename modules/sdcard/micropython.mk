@@ -1,3 +1,14 @@
 SDCARD_MOD_DIR := $(USERMOD_DIR)
 SRC_USERMOD += $(SDCARD_MOD_DIR)/sdcard.c
-CFLAGS_USERMOD += -I$(SDCARD_MOD_DIR)
\ No newline at end of file
+CFLAGS_USERMOD += -I$(SDCARD_MOD_DIR)
+
+# the unix port is a host build ~ the SDK calls are answered by sdcard_host.c and a simulated card
+ifeq ($(notdir $(CURDIR)),unix)
+SDCARD_HOST ?= 1
+endif
+
+ifeq ($(SDCARD_HOST),1)
+SRC_USERMOD += $(SDCARD_MOD_DIR)/sdcard_host.c $(SDCARD_MOD_DIR)/sdcard_sim.c
+CFLAGS_USERMOD += -DMODULE_SDCARD_ENABLED=1 -DSDCARD_HOST=1
+LDFLAGS_USERMOD += -lpthread
+endif
@@ -2,12 +2,11 @@
 #include "py/obj.h"
 #include "py/objstr.h"
 #include "py/objint.h"
-#include "pico/time.h"
-#include "hardware/spi.h"
-#include "hardware/gpio.h"
 #include "extmod/vfs.h"
+#include "sdcard_hal.h"
 #include <math.h>
 #include <string.h>
+#include <setjmp.h>
 
 
 #define SPI_BAUDRATE    (100000) //this is only the initialization baudrate
@@ -24,22 +23,75 @@
 #define IOCTL_BLK_ERASE (6)
 
 #define CMD0            (0x40) // CMD0 : init card; should return _IDLE_STATE
+#define CMD6            (0x46) // CMD6 : check/switch card function. Function group 1 holds high speed
 #define CMD8            (0x48) // CMD8 : determine card version
 #define CMD9            (0x49) // CMD9 : response R2 (R1 byte + 16-byte block read)
 #define CMD12           (0x4C) // CMD12: forces card to stop transmission in Multiple Block Read Operation
+#define CMD13           (0x4D) // ACMD13: read SD status. AU_SIZE sits in bits 431:428
 #define CMD16           (0x50) // CMD16: set block length to 512 bytes
 #define CMD17           (0x51) // CMD17: set read address for single block
 #define CMD18           (0x52) // CMD18: set read address for multiple blocks
+#define CMD23           (0x57) // CMD23: set block count of the next multi-block command (ACMD23: blocks to pre-erase)
 #define CMD24           (0x58) // CMD24: set write address for single block
 #define CMD25           (0x59) // CMD25: set write address for first block
+#define CMD32           (0x60) // CMD32: set first block to erase
+#define CMD33           (0x61) // CMD33: set last block to erase
+#define CMD38           (0x66) // CMD38: erase the selected range
 #define CMD41           (0x69) // CMD41: host capacity support information / activates card's initialization process.
+#define CMD51           (0x73) // ACMD51: read SCR register. CMD_SUPPORT bit 33 advertises CMD23
 #define CMD55           (0x77) // CMD55: next command is app command
 #define CMD58           (0x7a) // CMD58: read OCR register. CCS bit is assigned to OCR[30]
+#define CMD59           (0x7b) // CMD59: turn CRC checking on (arg 1) or off (arg 0)
 
 #define BLOCK           (0x200) //512
 #define FF              (uint8_t []){0xFF}
 
 #define CMD_TIMEOUT     (0x64)  //100
+#define PRE_ERASE_MIN   (0x10)  //open-ended writes of at least this many blocks announce a pre-erase count
+#define AU_DEFAULT      (0x2000) //4 MB in blocks ~ used when the card doesn't report its allocation unit
+#define BAUD_DEFAULT    (0x500000) //5 mb ~ also the reference rate of baudrate='auto'
+#define BAUD_HS         (50000000) //TRAN_SPEED of a card in high speed mode
+#define AUTO_PASSES     (4)         //verification rounds per candidate rate
+#define CRC_RETRIES     (3)         //attempts at a block that keeps failing its CRC before giving up
+#define LOGGER_RING     (16)        //blocks a logger's RAM ring holds unless told otherwise ~ 8 KB
+
+#define WAIT_SPIN_US    (200)       //polling budget before a wait starts yielding
+#define WAIT_NAP_US     (50)        //sleep between polls once yielding without the poll hook
+#define WAIT_CMD_US     (20000)     //R1 response deadline
+#define WAIT_TOKEN_US   (100000)    //read access deadline ~ 100 ms for SDHC/SDXC
+#define WAIT_BUSY_US    (500000)    //programming deadline ~ 500 ms for SDXC
+#define WAIT_ERASE_US   (2000000)   //busy deadline of one allocation unit erase
+
+#define WAIT_R1         (0)         //a byte with bit 7 clear
+#define WAIT_TOKEN      (1)         //anything but 0xFF ~ a start token or a data error token
+#define WAIT_BUSY       (2)         //anything but 0x00 ~ the card let go of MISO
+
+#define WORK_SLOTS      (8)         //requests the I/O worker ring holds
+#define WORK_READ       (0)
+#define WORK_WRITE      (1)
+#define WORK_SYNC       (2)
+#define WORK_READV      (3)         //`buf` holds the segments and `len` their count
+#define WORK_WRITEV     (4)
+#define ERR_RESPONSE    (-1)        //"Response Timeout" as an error code ~ for errors that cross from the worker
+
+#define BUS_DEVICES     (4)         //cards one SPI block can be shared by
+
+#define STAT_READ       (0)         //operation types the stats keep apart
+#define STAT_WRITE      (1)
+#define STAT_ERASE      (2)
+#define STAT_SYNC       (3)
+#define STAT_OPS        (4)
+#define STAT_BUCKETS    (24)        //log2 latency buckets ~ the last one holds everything from 2^22 us (4.2 s) up
+
+#define AIO_READ        (0)
+#define AIO_WRITE       (1)
+#define AIO_CLAIM       (0)         //awaitable phases ~ not started yet
+#define AIO_SETTLE      (1)         //a deferred write is still programming
+#define AIO_START       (2)         //next command of the run goes out
+#define AIO_TOKEN       (3)         //waiting for a start token
+#define AIO_SEND        (4)         //next data packet goes out
+#define AIO_BUSY        (5)         //the card is programming
+#define AIO_DONE        (6)
 
 #define IDLE_STATE      (0x01)
 #define ERASE_RESET     (0x02)
@@ -53,47 +105,243 @@
 #define TOKEN_STOP_TRAN (0xFD)
 #define TOKEN_DATA      (0xFE)
 
+#define DATA_ACCEPTED   (0x05)  //data response tokens (low 5 bits)
+#define DATA_CRC_ERROR  (0x0B)
+#define DATA_WR_ERROR   (0x0D)
 
+#define SNIFF_CRC16     (0x2)   //DMA sniffer calculation: CRC-16-CCITT
 
-//__> BUFFER SLICE _________________________________________________________________
-typedef struct{ 
-    uint8_t buff[BLOCK];
-    int len;
-} slice_obj_t;
-
-slice_obj_t slice(const uint8_t* buff, int size, int start, int end) {
-    slice_obj_t result = { .buff = {0}, .len = 0 };
-    if (start >= 0 && end <= size) {
-        int count = 0;
-        for (int i = start; i < end; i++) {
-            result.buff[count] = buff[i];
-            count++;
-        }
-        result.len = end - start;
-        return result;
-    }
-    else {
-        mp_raise_msg(&mp_type_IndexError, MP_ERROR_TEXT("index is out of range"));
-        result.len = -1;
-        return result;
-    }
-} 
 
 
 //__> SDObject __________________________________________________________________________
 const mp_obj_type_t sdcard_SDObject_type;
 
+//set-associative write-back sector cache ~ `lines` of 0 means disabled
+typedef struct {
+    uint8_t  *data;         //lines * BLOCK
+    uint32_t *tags;         //block held by each line
+    uint32_t *used;         //LRU stamp per line ~ 0 marks a free line
+    uint8_t  *dirty;
+    uint16_t  lines;
+    uint16_t  sets;
+    uint8_t   ways;
+    bool      keep;         //keep every miss, not only single-block ones
+    uint32_t  clock;
+    uint32_t  hits;
+    uint32_t  misses;
+    uint32_t  evictions;
+    uint32_t  writebacks;
+} sdcard_cache_t;
+
+STATIC void sdcard_cache_init(sdcard_cache_t *c, mp_int_t lines, mp_int_t ways) {
+    memset(c, 0, sizeof(sdcard_cache_t));
+    if (lines < 1) return;
+    if (lines > 0xFFFF) lines = 0xFFFF;
+    if (ways < 1 || ways > lines || ways > 0xFF) ways = (lines < 4) ? lines : 4;
+    
+    c->ways  = ways;
+    c->sets  = lines / ways;
+    c->lines = c->sets * c->ways;
+    c->data  = m_new(uint8_t , c->lines * BLOCK);
+    c->tags  = m_new(uint32_t, c->lines);
+    c->used  = m_new0(uint32_t, c->lines);
+    c->dirty = m_new0(uint8_t , c->lines);
+}
+
+//sequential read-ahead ~ `capacity` of 0 means disabled
+typedef struct {
+    uint8_t  *data;         //capacity * BLOCK
+    uint8_t  *served;       //per held block ~ whether a request has used it
+    uint32_t  capacity;     //blocks that fit the memory budget
+    uint32_t  start;        //first block held
+    uint32_t  count;        //blocks held
+    uint32_t  next;         //where a sequential request would start
+    uint32_t  window;       //blocks to read on the next sequential miss ~ 0 until a pattern shows up
+    uint32_t  hits;         //blocks served from read-ahead
+    uint32_t  misses;       //blocks the caller had to wait on the card for
+    uint32_t  prefetched;   //blocks read ahead of demand
+    uint32_t  wasted;       //blocks read ahead but dropped unused
+} sdcard_prefetch_t;
+
+STATIC void sdcard_prefetch_init(sdcard_prefetch_t *pf, mp_int_t budget) {
+    memset(pf, 0, sizeof(sdcard_prefetch_t));
+    if (budget < (BLOCK << 1)) return;
+    
+    pf->capacity = budget / BLOCK;
+    pf->data     = m_new(uint8_t, pf->capacity * BLOCK);
+    pf->served   = m_new0(uint8_t, pf->capacity);
+    pf->next     = 0xFFFFFFFF;
+}
+
+//contiguous single-block writes gathered into one CMD25 ~ `capacity` of 0 means disabled
+typedef struct {
+    uint8_t   *data;        //capacity * BLOCK
+    uint32_t   capacity;    //blocks held before the queue flushes itself
+    uint32_t   start;       //first queued block
+    uint32_t   count;       //blocks queued
+    uint32_t   flush_ms;    //age at which a pending run is flushed ~ 0 disables the timer
+    alarm_id_t alarm;       //0 when no timer is armed
+    uint32_t   queued;      //blocks that went through the queue
+    uint32_t   runs;        //transactions they were written in
+} sdcard_queue_t;
+
+STATIC void sdcard_queue_init(sdcard_queue_t *q, mp_int_t blocks, mp_int_t flush_ms) {
+    memset(q, 0, sizeof(sdcard_queue_t));
+    if (blocks < 2) return;
+    
+    q->capacity = blocks;
+    q->flush_ms = (flush_ms > 0) ? flush_ms : 0;
+    q->data     = m_new(uint8_t, q->capacity * BLOCK);
+}
+
+//how the driver waits on the card ~ spin for spin_us, then yield between polls until a wall-clock deadline
+typedef struct {
+    uint32_t  spin_us;
+    uint32_t  token_us;
+    uint32_t  busy_us;
+    uint32_t  erase_us;
+    bool      hook;         //yield with MICROPY_EVENT_POLL_HOOK instead of a plain nap
+    bool      yielding;     //inside the hook ~ scheduled code must not start traffic of its own
+    bool      defer;        //writes return once their data is accepted ~ busy is checked by the next command
+    bool      pending;      //the card may still be programming the last write
+    uint32_t  waits;
+    uint32_t  yields;
+    uint32_t  timeouts;
+    uint32_t  max_us;       //longest wait that succeeded
+    uint32_t  deferred;     //write transactions that returned before programming finished
+    uint64_t  blocked_us;   //time spent waiting out busy, deferred or not
+} sdcard_wait_t;
+
+//CRC7 on commands and CRC16 on data packets ~ off unless the card was told CMD59
+typedef struct {
+    bool      enabled;
+    bool      sniff;        //the DMA sniffer is accumulating the packet in flight
+    uint32_t  blocks;       //packets checked or generated
+    uint32_t  errors;       //mismatches seen on reads plus CRC rejections on writes
+    uint32_t  retries;
+    uint64_t  us;           //time spent producing checksums
+} sdcard_crc_t;
+
+//one operation type ~ bucket i of `hist` counts calls that took at least 2^(i-1) us and under 2^i us
+typedef struct {
+    uint32_t  calls;
+    uint32_t  single;       //calls of exactly one block
+    uint64_t  bytes;
+    uint64_t  us;
+    uint32_t  max_us;
+    uint32_t  hist[STAT_BUCKETS];
+} sdcard_op_stats_t;
+
+//always on ~ where the time of a call went: the card (token, busy), the bus (xfer) or the driver (the rest)
+typedef struct {
+    sdcard_op_stats_t op[STAT_OPS];
+    uint32_t  retries;      //commands sent again and blocks read or written again
+    uint32_t  timeouts;
+    uint64_t  token_us;     //waiting for responses and start tokens
+    uint64_t  busy_us;      //waiting out programming and erase
+    uint64_t  xfer_us;      //clocking data packets
+} sdcard_stats_t;
+
+//one traced command ~ 16 bytes, dumped as they are (little-endian) for tools/sdtrace.py
+typedef struct {
+    uint32_t  t_us;         //low 32 bits of time_us_64 when the command went out
+    uint32_t  arg;
+    uint32_t  len;          //data bytes moved under this command
+    uint16_t  polls;        //bytes polled waiting on the card ~ response, tokens and busy, saturating
+    uint8_t   cmd;          //command byte (0x40 | index), or TOKEN_STOP_TRAN
+    uint8_t   r1;           //0xFF when no response came
+} sdcard_trace_entry_t;
+
+//ring of the last `capacity` commands ~ `capacity` of 0 means off
+typedef struct {
+    sdcard_trace_entry_t *entries;
+    uint32_t  capacity;
+    uint32_t  count;        //entries ever written ~ the newest sits at (count - 1) % capacity
+} sdcard_trace_t;
+
+//one request, or the completion of one ~ `obj` keeps the caller's buffer alive until the slot is reused
+typedef struct {
+    uint32_t  tag;
+    uint8_t   op;           //WORK_READ, WORK_WRITE, WORK_SYNC, WORK_READV or WORK_WRITEV
+    bool      sync;         //a blocking call waits on it ~ it gets no completion entry
+    int       err;          //0, an errno or ERR_RESPONSE
+    uint32_t  blocknum;
+    uint8_t  *buf;
+    uint32_t  len;
+    mp_obj_t  obj;
+} sdcard_work_t;
+
+//one request of a vectored call ~ the blocks [block, block + nblocks) and the caller memory they go to or come from
+typedef struct {
+    uint32_t  block;
+    uint8_t  *buf;
+    uint32_t  nblocks;
+} sdcard_seg_t;
+
+//single-producer/single-consumer ring ~ the producer only moves tail, the consumer only moves head
+typedef struct {
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    sdcard_work_t     slots[WORK_SLOTS];
+} sdcard_ring_t;
+
+//core1 takes requests from `req` and answers on `done`
+typedef struct {
+    sdcard_ring_t     req;
+    sdcard_ring_t     done;
+    volatile bool     running;
+    volatile bool     stopped;
+    volatile uint32_t finished;     //tag of the last request carried out ~ requests finish in order
+    volatile int      sync_err;     //result of the last blocking request
+    uint32_t  tag;                  //tag of the last request posted
+    uint32_t  unpolled;             //submitted requests whose completion hasn't been polled
+} sdcard_worker_t;
+
+//one per SPI block ~ every card keeps its own chip-select and negotiated clock, and the block is set up for whichever card was selected last
+typedef struct {
+    struct _sdcard_SDObject_obj_t *dev[BUS_DEVICES];
+    struct _sdcard_SDObject_obj_t *active;  //the clock and format are this card's ~ NULL after spi_init
+    uint8_t   devices;
+    uint32_t  switches;     //times the bus changed hands
+} sdcard_bus_t;
+
+STATIC sdcard_bus_t sdcard_buses[2];
+
 typedef struct _sdcard_SDObject_obj_t {
     mp_obj_base_t base;
     spi_inst_t    *spi;
+    sdcard_bus_t  *bus;
     const char *type;
-    uint8_t   buffer[BLOCK];
     uint8_t   token[1];
     uint64_t  sectors;
     uint32_t  baudrate;
     uint8_t   cs;
     uint16_t  cdv;
     uint8_t   led;
+    bool      scr_cmd23;    //the card advertises CMD23
+    bool      cmd23;        //multi-block runs are announced with CMD23
+    uint32_t  au;           //allocation unit in blocks
+    uint32_t  tran_speed;   //card's rated clock in hz ~ from the CSD, or BAUD_HS after a CMD6 switch
+    bool      hs;           //switched to high speed mode
+    int8_t    dma_tx;   //-1 when the DMA engine is not in use
+    int8_t    dma_rx;
+    sdcard_crc_t crc;
+    sdcard_wait_t wait;
+    sdcard_stats_t stats;
+    sdcard_trace_t trace;
+    struct _sdcard_SDStream_obj_t *stream;  //open CMD18 stream holding the card, if any
+    struct _sdcard_SDAwait_obj_t  *aio;     //awaitable transfer holding the card, if any
+    struct _sdcard_SDLogger_obj_t *logger;  //raw region writer, if any ~ other traffic ends its open run
+    sdcard_worker_t *worker;                //core1 I/O worker ~ NULL when card traffic runs on the calling core
+    bool      use_worker;                   //worker=True ~ the worker is stopped while unmounted and started again on mount
+    sdcard_cache_t cache;
+    sdcard_prefetch_t prefetch;
+    sdcard_queue_t    queue;
+    uint32_t  erase_start;          //erase ioctls not sent yet ~ one range of blocks that continue each other
+    uint32_t  erase_count;
+    sdcard_cache_t    pinned;       //filesystem metadata ~ data traffic never touches these lines
+    uint32_t  pin_start[2];         //first FAT and root directory
+    uint32_t  pin_count[2];
 } sdcard_SDObject_obj_t;
 
 STATIC void SDObject_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
@@ -102,6 +350,488 @@ STATIC void SDObject_print(const mp_print_t *print, mp_obj_t self_in, mp_print_k
     mp_printf(print, "SDObject()");
 }
 
+//__> CRC _____________________________________________________________________________________
+//CRC16-CCITT (poly 0x1021, seed 0) sliced 4 ways ~ table k advances a byte k positions further from the end
+STATIC const uint16_t crc16_tables[4][256] = {
+    {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7, 0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+        0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6, 0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+        0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485, 0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+        0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4, 0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+        0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823, 0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+        0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12, 0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+        0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41, 0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+        0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70, 0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+        0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F, 0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+        0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E, 0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+        0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D, 0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+        0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C, 0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+        0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB, 0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+        0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A, 0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+        0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9, 0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+        0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8, 0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+    },
+    {
+        0x0000, 0x3331, 0x6662, 0x5553, 0xCCC4, 0xFFF5, 0xAAA6, 0x9997, 0x89A9, 0xBA98, 0xEFCB, 0xDCFA, 0x456D, 0x765C, 0x230F, 0x103E,
+        0x0373, 0x3042, 0x6511, 0x5620, 0xCFB7, 0xFC86, 0xA9D5, 0x9AE4, 0x8ADA, 0xB9EB, 0xECB8, 0xDF89, 0x461E, 0x752F, 0x207C, 0x134D,
+        0x06E6, 0x35D7, 0x6084, 0x53B5, 0xCA22, 0xF913, 0xAC40, 0x9F71, 0x8F4F, 0xBC7E, 0xE92D, 0xDA1C, 0x438B, 0x70BA, 0x25E9, 0x16D8,
+        0x0595, 0x36A4, 0x63F7, 0x50C6, 0xC951, 0xFA60, 0xAF33, 0x9C02, 0x8C3C, 0xBF0D, 0xEA5E, 0xD96F, 0x40F8, 0x73C9, 0x269A, 0x15AB,
+        0x0DCC, 0x3EFD, 0x6BAE, 0x589F, 0xC108, 0xF239, 0xA76A, 0x945B, 0x8465, 0xB754, 0xE207, 0xD136, 0x48A1, 0x7B90, 0x2EC3, 0x1DF2,
+        0x0EBF, 0x3D8E, 0x68DD, 0x5BEC, 0xC27B, 0xF14A, 0xA419, 0x9728, 0x8716, 0xB427, 0xE174, 0xD245, 0x4BD2, 0x78E3, 0x2DB0, 0x1E81,
+        0x0B2A, 0x381B, 0x6D48, 0x5E79, 0xC7EE, 0xF4DF, 0xA18C, 0x92BD, 0x8283, 0xB1B2, 0xE4E1, 0xD7D0, 0x4E47, 0x7D76, 0x2825, 0x1B14,
+        0x0859, 0x3B68, 0x6E3B, 0x5D0A, 0xC49D, 0xF7AC, 0xA2FF, 0x91CE, 0x81F0, 0xB2C1, 0xE792, 0xD4A3, 0x4D34, 0x7E05, 0x2B56, 0x1867,
+        0x1B98, 0x28A9, 0x7DFA, 0x4ECB, 0xD75C, 0xE46D, 0xB13E, 0x820F, 0x9231, 0xA100, 0xF453, 0xC762, 0x5EF5, 0x6DC4, 0x3897, 0x0BA6,
+        0x18EB, 0x2BDA, 0x7E89, 0x4DB8, 0xD42F, 0xE71E, 0xB24D, 0x817C, 0x9142, 0xA273, 0xF720, 0xC411, 0x5D86, 0x6EB7, 0x3BE4, 0x08D5,
+        0x1D7E, 0x2E4F, 0x7B1C, 0x482D, 0xD1BA, 0xE28B, 0xB7D8, 0x84E9, 0x94D7, 0xA7E6, 0xF2B5, 0xC184, 0x5813, 0x6B22, 0x3E71, 0x0D40,
+        0x1E0D, 0x2D3C, 0x786F, 0x4B5E, 0xD2C9, 0xE1F8, 0xB4AB, 0x879A, 0x97A4, 0xA495, 0xF1C6, 0xC2F7, 0x5B60, 0x6851, 0x3D02, 0x0E33,
+        0x1654, 0x2565, 0x7036, 0x4307, 0xDA90, 0xE9A1, 0xBCF2, 0x8FC3, 0x9FFD, 0xACCC, 0xF99F, 0xCAAE, 0x5339, 0x6008, 0x355B, 0x066A,
+        0x1527, 0x2616, 0x7345, 0x4074, 0xD9E3, 0xEAD2, 0xBF81, 0x8CB0, 0x9C8E, 0xAFBF, 0xFAEC, 0xC9DD, 0x504A, 0x637B, 0x3628, 0x0519,
+        0x10B2, 0x2383, 0x76D0, 0x45E1, 0xDC76, 0xEF47, 0xBA14, 0x8925, 0x991B, 0xAA2A, 0xFF79, 0xCC48, 0x55DF, 0x66EE, 0x33BD, 0x008C,
+        0x13C1, 0x20F0, 0x75A3, 0x4692, 0xDF05, 0xEC34, 0xB967, 0x8A56, 0x9A68, 0xA959, 0xFC0A, 0xCF3B, 0x56AC, 0x659D, 0x30CE, 0x03FF
+    },
+    {
+        0x0000, 0x3730, 0x6E60, 0x5950, 0xDCC0, 0xEBF0, 0xB2A0, 0x8590, 0xA9A1, 0x9E91, 0xC7C1, 0xF0F1, 0x7561, 0x4251, 0x1B01, 0x2C31,
+        0x4363, 0x7453, 0x2D03, 0x1A33, 0x9FA3, 0xA893, 0xF1C3, 0xC6F3, 0xEAC2, 0xDDF2, 0x84A2, 0xB392, 0x3602, 0x0132, 0x5862, 0x6F52,
+        0x86C6, 0xB1F6, 0xE8A6, 0xDF96, 0x5A06, 0x6D36, 0x3466, 0x0356, 0x2F67, 0x1857, 0x4107, 0x7637, 0xF3A7, 0xC497, 0x9DC7, 0xAAF7,
+        0xC5A5, 0xF295, 0xABC5, 0x9CF5, 0x1965, 0x2E55, 0x7705, 0x4035, 0x6C04, 0x5B34, 0x0264, 0x3554, 0xB0C4, 0x87F4, 0xDEA4, 0xE994,
+        0x1DAD, 0x2A9D, 0x73CD, 0x44FD, 0xC16D, 0xF65D, 0xAF0D, 0x983D, 0xB40C, 0x833C, 0xDA6C, 0xED5C, 0x68CC, 0x5FFC, 0x06AC, 0x319C,
+        0x5ECE, 0x69FE, 0x30AE, 0x079E, 0x820E, 0xB53E, 0xEC6E, 0xDB5E, 0xF76F, 0xC05F, 0x990F, 0xAE3F, 0x2BAF, 0x1C9F, 0x45CF, 0x72FF,
+        0x9B6B, 0xAC5B, 0xF50B, 0xC23B, 0x47AB, 0x709B, 0x29CB, 0x1EFB, 0x32CA, 0x05FA, 0x5CAA, 0x6B9A, 0xEE0A, 0xD93A, 0x806A, 0xB75A,
+        0xD808, 0xEF38, 0xB668, 0x8158, 0x04C8, 0x33F8, 0x6AA8, 0x5D98, 0x71A9, 0x4699, 0x1FC9, 0x28F9, 0xAD69, 0x9A59, 0xC309, 0xF439,
+        0x3B5A, 0x0C6A, 0x553A, 0x620A, 0xE79A, 0xD0AA, 0x89FA, 0xBECA, 0x92FB, 0xA5CB, 0xFC9B, 0xCBAB, 0x4E3B, 0x790B, 0x205B, 0x176B,
+        0x7839, 0x4F09, 0x1659, 0x2169, 0xA4F9, 0x93C9, 0xCA99, 0xFDA9, 0xD198, 0xE6A8, 0xBFF8, 0x88C8, 0x0D58, 0x3A68, 0x6338, 0x5408,
+        0xBD9C, 0x8AAC, 0xD3FC, 0xE4CC, 0x615C, 0x566C, 0x0F3C, 0x380C, 0x143D, 0x230D, 0x7A5D, 0x4D6D, 0xC8FD, 0xFFCD, 0xA69D, 0x91AD,
+        0xFEFF, 0xC9CF, 0x909F, 0xA7AF, 0x223F, 0x150F, 0x4C5F, 0x7B6F, 0x575E, 0x606E, 0x393E, 0x0E0E, 0x8B9E, 0xBCAE, 0xE5FE, 0xD2CE,
+        0x26F7, 0x11C7, 0x4897, 0x7FA7, 0xFA37, 0xCD07, 0x9457, 0xA367, 0x8F56, 0xB866, 0xE136, 0xD606, 0x5396, 0x64A6, 0x3DF6, 0x0AC6,
+        0x6594, 0x52A4, 0x0BF4, 0x3CC4, 0xB954, 0x8E64, 0xD734, 0xE004, 0xCC35, 0xFB05, 0xA255, 0x9565, 0x10F5, 0x27C5, 0x7E95, 0x49A5,
+        0xA031, 0x9701, 0xCE51, 0xF961, 0x7CF1, 0x4BC1, 0x1291, 0x25A1, 0x0990, 0x3EA0, 0x67F0, 0x50C0, 0xD550, 0xE260, 0xBB30, 0x8C00,
+        0xE352, 0xD462, 0x8D32, 0xBA02, 0x3F92, 0x08A2, 0x51F2, 0x66C2, 0x4AF3, 0x7DC3, 0x2493, 0x13A3, 0x9633, 0xA103, 0xF853, 0xCF63
+    },
+    {
+        0x0000, 0x76B4, 0xED68, 0x9BDC, 0xCAF1, 0xBC45, 0x2799, 0x512D, 0x85C3, 0xF377, 0x68AB, 0x1E1F, 0x4F32, 0x3986, 0xA25A, 0xD4EE,
+        0x1BA7, 0x6D13, 0xF6CF, 0x807B, 0xD156, 0xA7E2, 0x3C3E, 0x4A8A, 0x9E64, 0xE8D0, 0x730C, 0x05B8, 0x5495, 0x2221, 0xB9FD, 0xCF49,
+        0x374E, 0x41FA, 0xDA26, 0xAC92, 0xFDBF, 0x8B0B, 0x10D7, 0x6663, 0xB28D, 0xC439, 0x5FE5, 0x2951, 0x787C, 0x0EC8, 0x9514, 0xE3A0,
+        0x2CE9, 0x5A5D, 0xC181, 0xB735, 0xE618, 0x90AC, 0x0B70, 0x7DC4, 0xA92A, 0xDF9E, 0x4442, 0x32F6, 0x63DB, 0x156F, 0x8EB3, 0xF807,
+        0x6E9C, 0x1828, 0x83F4, 0xF540, 0xA46D, 0xD2D9, 0x4905, 0x3FB1, 0xEB5F, 0x9DEB, 0x0637, 0x7083, 0x21AE, 0x571A, 0xCCC6, 0xBA72,
+        0x753B, 0x038F, 0x9853, 0xEEE7, 0xBFCA, 0xC97E, 0x52A2, 0x2416, 0xF0F8, 0x864C, 0x1D90, 0x6B24, 0x3A09, 0x4CBD, 0xD761, 0xA1D5,
+        0x59D2, 0x2F66, 0xB4BA, 0xC20E, 0x9323, 0xE597, 0x7E4B, 0x08FF, 0xDC11, 0xAAA5, 0x3179, 0x47CD, 0x16E0, 0x6054, 0xFB88, 0x8D3C,
+        0x4275, 0x34C1, 0xAF1D, 0xD9A9, 0x8884, 0xFE30, 0x65EC, 0x1358, 0xC7B6, 0xB102, 0x2ADE, 0x5C6A, 0x0D47, 0x7BF3, 0xE02F, 0x969B,
+        0xDD38, 0xAB8C, 0x3050, 0x46E4, 0x17C9, 0x617D, 0xFAA1, 0x8C15, 0x58FB, 0x2E4F, 0xB593, 0xC327, 0x920A, 0xE4BE, 0x7F62, 0x09D6,
+        0xC69F, 0xB02B, 0x2BF7, 0x5D43, 0x0C6E, 0x7ADA, 0xE106, 0x97B2, 0x435C, 0x35E8, 0xAE34, 0xD880, 0x89AD, 0xFF19, 0x64C5, 0x1271,
+        0xEA76, 0x9CC2, 0x071E, 0x71AA, 0x2087, 0x5633, 0xCDEF, 0xBB5B, 0x6FB5, 0x1901, 0x82DD, 0xF469, 0xA544, 0xD3F0, 0x482C, 0x3E98,
+        0xF1D1, 0x8765, 0x1CB9, 0x6A0D, 0x3B20, 0x4D94, 0xD648, 0xA0FC, 0x7412, 0x02A6, 0x997A, 0xEFCE, 0xBEE3, 0xC857, 0x538B, 0x253F,
+        0xB3A4, 0xC510, 0x5ECC, 0x2878, 0x7955, 0x0FE1, 0x943D, 0xE289, 0x3667, 0x40D3, 0xDB0F, 0xADBB, 0xFC96, 0x8A22, 0x11FE, 0x674A,
+        0xA803, 0xDEB7, 0x456B, 0x33DF, 0x62F2, 0x1446, 0x8F9A, 0xF92E, 0x2DC0, 0x5B74, 0xC0A8, 0xB61C, 0xE731, 0x9185, 0x0A59, 0x7CED,
+        0x84EA, 0xF25E, 0x6982, 0x1F36, 0x4E1B, 0x38AF, 0xA373, 0xD5C7, 0x0129, 0x779D, 0xEC41, 0x9AF5, 0xCBD8, 0xBD6C, 0x26B0, 0x5004,
+        0x9F4D, 0xE9F9, 0x7225, 0x0491, 0x55BC, 0x2308, 0xB8D4, 0xCE60, 0x1A8E, 0x6C3A, 0xF7E6, 0x8152, 0xD07F, 0xA6CB, 0x3D17, 0x4BA3
+    }
+};
+
+STATIC uint16_t sdcard_crc16_table(const uint8_t *buf, int len) {
+    uint16_t crc = 0;
+    int i = 0;
+    
+    for (; i + 4 <= len; i += 4) {
+        crc ^= (buf[i] << 8) | buf[i + 1];
+        crc  = crc16_tables[3][crc >> 8] ^ crc16_tables[2][crc & 0xFF] ^ crc16_tables[1][buf[i + 2]] ^ crc16_tables[0][buf[i + 3]];
+    }
+    
+    for (; i < len; i++)
+        crc = (crc << 8) ^ crc16_tables[0][(crc >> 8) ^ buf[i]];
+    
+    return crc;
+}
+
+//commands are 6 bytes ~ bitwise is cheap enough here
+STATIC uint8_t sdcard_crc7(const uint8_t *buf, int len) {
+    uint8_t crc = 0;
+    for (int i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int b = 0; b < 8; b++)
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x12 : (crc << 1);
+    }
+    return crc >> 1;
+}
+
+//checksum of the packet that just moved ~ the DMA sniffer already has it when it was watching
+STATIC uint16_t sdcard_crc16(sdcard_SDObject_obj_t *self, const uint8_t *buf, int len) {
+    uint64_t t = time_us_64();
+    uint16_t crc;
+    
+#if SDCARD_HAL_DMA
+    if (self->crc.sniff) {
+        crc = dma_hw->sniff_data & 0xFFFF;
+        self->crc.sniff = false;
+    } 
+    else
+#endif
+    crc = sdcard_crc16_table(buf, len);
+    
+    self->crc.blocks++;
+    self->crc.us += time_us_64() - t;
+    return crc;
+}
+
+
+//__> STATS _____________________________________________________________________________________
+STATIC uint8_t sdcard_stats_bucket(uint32_t us) {
+    uint8_t b = us ? 32 - __builtin_clz(us) : 0;
+    return (b < STAT_BUCKETS) ? b : STAT_BUCKETS - 1;
+}
+
+//one finished call of type `op` that began at `start`
+STATIC void sdcard_stats_op(sdcard_SDObject_obj_t *self, uint8_t op, uint32_t len, uint64_t start) {
+    sdcard_op_stats_t *s = &self->stats.op[op];
+    uint32_t us = time_us_64() - start;
+    
+    s->calls++;
+    if (len == BLOCK) s->single++;
+    s->bytes += len;
+    s->us    += us;
+    if (us > s->max_us) s->max_us = us;
+    s->hist[sdcard_stats_bucket(us)]++;
+}
+
+STATIC void sdcard_stats_wait(sdcard_SDObject_obj_t *self, uint8_t kind, uint64_t us) {
+    if (kind == WAIT_BUSY) self->stats.busy_us  += us;
+    else                   self->stats.token_us += us;
+}
+
+STATIC mp_obj_t sdcard_stats_op_dict(sdcard_op_stats_t *s) {
+    mp_obj_t hist[STAT_BUCKETS];
+    for (int i = 0; i < STAT_BUCKETS; i++) hist[i] = mp_obj_new_int_from_uint(s->hist[i]);
+    
+    mp_obj_t info = mp_obj_new_dict(7);
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_calls) , mp_obj_new_int_from_uint(s->calls));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_single), mp_obj_new_int_from_uint(s->single));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_multi) , mp_obj_new_int_from_uint(s->calls - s->single));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_bytes) , mp_obj_new_int_from_ull(s->bytes));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_us)    , mp_obj_new_int_from_ull(s->us));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_max_us), mp_obj_new_int_from_uint(s->max_us));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_hist)  , mp_obj_new_list(STAT_BUCKETS, hist));
+    return info;
+}
+
+//a snapshot of everything counted so far ~ `reset` starts the counts over once it is taken
+STATIC mp_obj_t SDObject_stats(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum {ARG_reset};
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_reset     , MP_ARG_BOOL, {.u_bool = false}},
+    };
+    
+    sdcard_SDObject_obj_t *self = MP_OBJ_TO_PTR(pos_args[0]);
+    mp_arg_val_t kw[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, kw);
+    
+    sdcard_stats_t *s = &self->stats;
+    mp_obj_t info = mp_obj_new_dict(9);
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_read)    , sdcard_stats_op_dict(&s->op[STAT_READ]));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_write)   , sdcard_stats_op_dict(&s->op[STAT_WRITE]));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_erase)   , sdcard_stats_op_dict(&s->op[STAT_ERASE]));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_sync)    , sdcard_stats_op_dict(&s->op[STAT_SYNC]));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_retries) , mp_obj_new_int_from_uint(s->retries));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_timeouts), mp_obj_new_int_from_uint(s->timeouts));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_token_us), mp_obj_new_int_from_ull(s->token_us));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_busy_us) , mp_obj_new_int_from_ull(s->busy_us));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_xfer_us) , mp_obj_new_int_from_ull(s->xfer_us));
+    
+    if (kw[ARG_reset].u_bool) memset(s, 0, sizeof(sdcard_stats_t));
+    return info;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(SDObject_stats_obj, 1, SDObject_stats);
+
+
+//__> TRACE _____________________________________________________________________________________
+//callers check `capacity` first ~ a disabled trace costs one compare per command, wait and packet
+STATIC sdcard_trace_entry_t *sdcard_trace_cmd(sdcard_SDObject_obj_t *self, uint8_t cmd, uint32_t arg) {
+    sdcard_trace_t *t = &self->trace;
+    sdcard_trace_entry_t *e = &t->entries[t->count++ % t->capacity];
+    e->t_us  = time_us_64();
+    e->arg   = arg;
+    e->len   = 0;
+    e->polls = 0;
+    e->cmd   = cmd;
+    e->r1    = 0xFF;
+    return e;
+}
+
+//the newest entry ~ NULL before the first command
+STATIC sdcard_trace_entry_t *sdcard_trace_last(sdcard_SDObject_obj_t *self) {
+    sdcard_trace_t *t = &self->trace;
+    return t->count ? &t->entries[(t->count - 1) % t->capacity] : NULL;
+}
+
+STATIC void sdcard_trace_data(sdcard_SDObject_obj_t *self, uint32_t len) {
+    sdcard_trace_entry_t *e = sdcard_trace_last(self);
+    if (e) e->len += len;
+}
+
+STATIC void sdcard_trace_polls(sdcard_SDObject_obj_t *self, uint32_t polls) {
+    sdcard_trace_entry_t *e = sdcard_trace_last(self);
+    if (e) e->polls = (e->polls + polls > 0xFFFF) ? 0xFFFF : e->polls + polls;
+}
+
+STATIC void sdcard_trace_init(sdcard_trace_t *t, mp_int_t entries) {
+    memset(t, 0, sizeof(sdcard_trace_t));
+    if (entries < 1) return;
+    
+    t->capacity = entries;
+    t->entries  = m_new0(sdcard_trace_entry_t, entries);
+}
+
+
+//__> BUS _____________________________________________________________________________________
+STATIC void sdcard_stream_park(sdcard_SDObject_obj_t *self);
+STATIC void sdcard_logger_park(sdcard_SDObject_obj_t *self);
+
+//joins the bus of SPI block `index` ~ the block is only reset when no other card uses it
+STATIC void sdcard_bus_attach(sdcard_SDObject_obj_t *self, uint8_t index) {
+    sdcard_bus_t *bus = &sdcard_buses[index];
+    uint8_t slot = bus->devices;
+    
+    for (uint8_t i = 0; i < bus->devices; i++) {
+        if (bus->dev[i]->worker != NULL) mp_raise_OSError(16); // EBUSY ~ core1 owns this bus
+        if (bus->dev[i]->cs == self->cs) slot = i;              //the same card again ~ the stale object gives up its place
+    }
+    
+    if (slot == BUS_DEVICES) mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Bus Full"));
+    if (bus->devices - (slot < bus->devices) == 0) {
+        spi_init(self->spi, SPI_BAUDRATE);
+        bus->active = NULL;
+    }
+    
+    bus->dev[slot] = self;
+    if (slot == bus->devices) bus->devices++;
+    self->bus = bus;
+}
+
+STATIC void sdcard_bus_detach(sdcard_SDObject_obj_t *self) {
+    sdcard_bus_t *bus = self->bus;
+    if (bus == NULL) return;
+    
+    for (uint8_t i = 0; i < bus->devices; i++) {
+        if (bus->dev[i] == self) {
+            bus->dev[i] = bus->dev[--bus->devices];
+            break;
+        }
+    }
+    
+    if (bus->active == self) bus->active = NULL;
+    self->bus = NULL;
+}
+
+//hands the bus to this card ~ an open stream or logger run on the previous one is parked first, at that card's clock
+STATIC void sdcard_bus_use(sdcard_SDObject_obj_t *self) {
+    sdcard_bus_t *bus = self->bus;
+    if (bus->active != NULL) {
+        sdcard_stream_park(bus->active);
+        sdcard_logger_park(bus->active);
+    }
+    
+    spi_set_format(self->spi, SPI_BITS, SPI_POLARITY, SPI_PHASE, SPI_FIRSTBIT);
+    spi_set_baudrate(self->spi, self->baudrate);
+    bus->active = self;
+    bus->switches++;
+}
+
+//asserts chip-select ~ the bus is only reconfigured when it was last set up for another card
+STATIC void sdcard_select(sdcard_SDObject_obj_t *self) {
+    if (self->bus->active != self) sdcard_bus_use(self);
+    gpio_put(self->cs, 0);
+}
+
+STATIC uint32_t sdcard_clock_set(sdcard_SDObject_obj_t *self, uint32_t hz) {
+    if (self->bus->active != self) sdcard_bus_use(self);
+    return self->baudrate = spi_set_baudrate(self->spi, hz);
+}
+
+//another card on the bus is mid-transfer ~ its wait is yielding to scheduled code, or an awaitable holds its chip-select down
+STATIC bool sdcard_bus_busy(sdcard_SDObject_obj_t *self) {
+    sdcard_bus_t *bus = self->bus;
+    for (uint8_t i = 0; i < bus->devices; i++) {
+        sdcard_SDObject_obj_t *d = bus->dev[i];
+        if (d != self && (d->wait.yielding || d->aio != NULL)) return true;
+    }
+    return false;
+}
+
+
+//__> FAULT _____________________________________________________________________________________
+//core1 has no Python thread state ~ errors raised on the I/O worker unwind to its loop instead
+STATIC jmp_buf sdcard_fault;
+STATIC sdcard_SDObject_obj_t *sdcard_worker_owner = NULL;
+
+NORETURN STATIC void sdcard_raise(int err) {
+    if (get_core_num() == 1 && sdcard_worker_owner != NULL) longjmp(sdcard_fault, err);
+    if (err == ERR_RESPONSE) mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Response Timeout"));
+    mp_raise_OSError(err);
+}
+
+STATIC void sdcard_worker_drain(sdcard_SDObject_obj_t *self);
+
+
+//__> WAIT _____________________________________________________________________________________
+STATIC void sdcard_wait_init(sdcard_wait_t *w) {
+    memset(w, 0, sizeof(sdcard_wait_t));
+    w->spin_us  = WAIT_SPIN_US;
+    w->token_us = WAIT_TOKEN_US;
+    w->busy_us  = WAIT_BUSY_US;
+    w->erase_us = WAIT_ERASE_US;
+}
+
+//scheduled Python code can run while a wait yields, and other tasks while an awaitable holds the card ~ neither may start traffic of its own, on this card or another one on the bus
+STATIC void sdcard_check_idle(sdcard_SDObject_obj_t *self) {
+    if (self->wait.yielding || self->aio != NULL || sdcard_bus_busy(self)) mp_raise_OSError(16); // EBUSY
+    
+    //traffic from this core waits for the I/O worker to run dry
+    if (self->worker != NULL) sdcard_worker_drain(self);
+}
+
+STATIC void sdcard_wait_yield(sdcard_SDObject_obj_t *self) {
+    sdcard_wait_t *w = &self->wait;
+    w->yields++;
+    
+    //the hook can't run on the I/O worker
+    if (!w->hook || get_core_num() == 1) {
+        sleep_us(WAIT_NAP_US);
+        return;
+    }
+    
+    //a pending KeyboardInterrupt surfaces here ~ the card is let go before it propagates
+    nlr_buf_t nlr;
+    w->yielding = true;
+    if (nlr_push(&nlr) == 0) {
+        MICROPY_EVENT_POLL_HOOK
+        nlr_pop();
+        w->yielding = false;
+    } else {
+        w->yielding = false;
+        gpio_put(self->cs, 1);
+        nlr_jump(nlr.ret_val);
+    }
+}
+
+STATIC bool sdcard_wait_met(uint8_t kind, uint8_t b) {
+    return (kind == WAIT_R1 && !(b & 0x80)) || (kind == WAIT_TOKEN && b != 0xFF) || (kind == WAIT_BUSY && b != 0x00);
+}
+
+//polls single bytes until `kind` is satisfied or budget_us has passed ~ the last byte is left in self->token
+STATIC bool sdcard_wait(sdcard_SDObject_obj_t *self, uint8_t kind, uint32_t budget_us) {
+    sdcard_wait_t *w = &self->wait;
+    uint64_t start    = time_us_64();
+    uint64_t spin     = start + w->spin_us;
+    uint64_t deadline = start + budget_us;
+    uint32_t polls    = 0;
+    
+    for (;;) {
+        spi_read_blocking(self->spi, 0xFF, self->token, 1);
+        polls++;
+        if (sdcard_wait_met(kind, self->token[0])) break;
+        
+        uint64_t now = time_us_64();
+        if (now >= deadline) {
+            w->timeouts++;
+            self->stats.timeouts++;
+            sdcard_stats_wait(self, kind, now - start);
+            if (self->trace.capacity) sdcard_trace_polls(self, polls);
+            return false;
+        }
+        if (now >= spin) sdcard_wait_yield(self);
+    }
+    
+    uint32_t waited = time_us_64() - start;
+    sdcard_stats_wait(self, kind, waited);
+    if (self->trace.capacity) sdcard_trace_polls(self, polls);
+    if (waited > w->max_us) w->max_us = waited;
+    w->waits++;
+    return true;
+}
+
+//waits out programming/erase busy with CS held ~ raises ETIMEDOUT past the deadline
+STATIC void sdcard_wait_busy(sdcard_SDObject_obj_t *self, uint32_t budget_us) {
+    uint64_t start = time_us_64();
+    bool done = sdcard_wait(self, WAIT_BUSY, budget_us);
+    self->wait.blocked_us += time_us_64() - start;
+    if (done) return;
+    
+    gpio_put(self->cs, 1);
+    spi_write_blocking(self->spi, FF, 1);
+    sdcard_raise(110); // ETIMEDOUT
+}
+
+//ends a write transaction and releases the card ~ with `defer` programming finishes in the background
+STATIC void sdcard_busy_end(sdcard_SDObject_obj_t *self) {
+    if (self->wait.defer) {
+        self->wait.pending = true;
+        self->wait.deferred++;
+    } 
+    else sdcard_wait_busy(self, self->wait.busy_us);
+    
+    gpio_put(self->cs, 1);
+    spi_write_blocking(self->spi, FF, 1);
+}
+
+//a deferred write has to finish programming before the card takes anything new ~ re-asserting CS shows its busy state again
+STATIC void sdcard_busy_settle(sdcard_SDObject_obj_t *self) {
+    if (!self->wait.pending) return;
+    self->wait.pending = false;
+    
+    sdcard_select(self);
+    sdcard_wait_busy(self, self->wait.busy_us);
+    gpio_put(self->cs, 1);
+    spi_write_blocking(self->spi, FF, 1);
+}
+
+//changes only what is passed ~ returns the policy in use and what waiting has cost so far
+STATIC mp_obj_t SDObject_wait(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum {ARG_spin_us, ARG_token_ms, ARG_busy_ms, ARG_erase_ms, ARG_hook, ARG_defer};
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_spin_us   , MP_ARG_OBJ , {.u_obj = MP_OBJ_NULL}},
+        { MP_QSTR_token_ms  , MP_ARG_OBJ , {.u_obj = MP_OBJ_NULL}},
+        { MP_QSTR_busy_ms   , MP_ARG_OBJ , {.u_obj = MP_OBJ_NULL}},
+        { MP_QSTR_erase_ms  , MP_ARG_OBJ , {.u_obj = MP_OBJ_NULL}},
+        { MP_QSTR_hook      , MP_ARG_OBJ , {.u_obj = MP_OBJ_NULL}},
+        { MP_QSTR_defer     , MP_ARG_OBJ , {.u_obj = MP_OBJ_NULL}},
+    };
+    
+    sdcard_SDObject_obj_t *self = MP_OBJ_TO_PTR(pos_args[0]);
+    mp_arg_val_t kw[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, kw);
+    
+    sdcard_wait_t *w = &self->wait;
+    if (kw[ARG_spin_us].u_obj  != MP_OBJ_NULL) w->spin_us  = mp_obj_get_int(kw[ARG_spin_us].u_obj);
+    if (kw[ARG_token_ms].u_obj != MP_OBJ_NULL) w->token_us = mp_obj_get_int(kw[ARG_token_ms].u_obj) * 1000;
+    if (kw[ARG_busy_ms].u_obj  != MP_OBJ_NULL) w->busy_us  = mp_obj_get_int(kw[ARG_busy_ms].u_obj)  * 1000;
+    if (kw[ARG_erase_ms].u_obj != MP_OBJ_NULL) w->erase_us = mp_obj_get_int(kw[ARG_erase_ms].u_obj) * 1000;
+    if (kw[ARG_hook].u_obj     != MP_OBJ_NULL) w->hook     = mp_obj_is_true(kw[ARG_hook].u_obj);
+    
+    //turning deferral off shouldn't leave a write in flight
+    if (kw[ARG_defer].u_obj != MP_OBJ_NULL) {
+        w->defer = mp_obj_is_true(kw[ARG_defer].u_obj);
+        if (!w->defer) sdcard_busy_settle(self);
+    }
+    
+    mp_obj_t info = mp_obj_new_dict(13);
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_spin_us) , mp_obj_new_int_from_uint(w->spin_us));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_token_ms), mp_obj_new_int_from_uint(w->token_us / 1000));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_busy_ms) , mp_obj_new_int_from_uint(w->busy_us  / 1000));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_erase_ms), mp_obj_new_int_from_uint(w->erase_us / 1000));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_hook)    , mp_obj_new_bool(w->hook));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_defer)   , mp_obj_new_bool(w->defer));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_pending) , mp_obj_new_bool(w->pending));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_deferred), mp_obj_new_int_from_uint(w->deferred));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_blocked_us), mp_obj_new_int_from_ull(w->blocked_us));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_waits)   , mp_obj_new_int_from_uint(w->waits));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_yields)  , mp_obj_new_int_from_uint(w->yields));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_timeouts), mp_obj_new_int_from_uint(w->timeouts));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_max_us)  , mp_obj_new_int_from_uint(w->max_us));
+    return info;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(SDObject_wait_obj, 1, SDObject_wait);
+
+
 //used for defaulting cmd arguments
 typedef struct {
     sdcard_SDObject_obj_t *self; 
@@ -119,23 +849,26 @@ typedef struct {
 STATIC int sdcard_cmd_base(sdcard_SDObject_obj_t *self, uint8_t cmd, uint32_t arg, uint8_t crc, uint8_t final, bool hold, bool skip) {
     //mp_printf(MP_PYTHON_PRINTER, "cmd %u, arg %u, crc %u, final %u, hold %b, skip %b\n", cmd, arg, crc, final, hold, skip);
     
-    gpio_put(self->cs, 0);
+    if (self->wait.pending) sdcard_busy_settle(self);
+    
+    sdcard_trace_entry_t *traced = self->trace.capacity ? sdcard_trace_cmd(self, cmd, arg) : NULL;
+    
+    sdcard_select(self);
     uint8_t cmd_stream[6] = {cmd, ((arg >> 24) & 0xFF), ((arg >> 16) & 0xFF), ((arg >> 8) & 0xFF), (arg & 0xFF), crc};
+    if (self->crc.enabled) cmd_stream[5] = (sdcard_crc7(cmd_stream, 5) << 1) | 0x01;
     
     spi_write_blocking(self->spi, cmd_stream, 6);
     
     if (skip) spi_read_blocking(self->spi, 0xFF, self->token, 1);
     
-    for (int i=0; i<CMD_TIMEOUT; i++){
-        spi_read_blocking(self->spi, 0xFF, self->token, 1);
-        if((self->token[0] & 0x80) == 0x00){
-            for(int j=0; j<final; j++) spi_write_blocking(self->spi, FF, 1);
-            if (!hold){
-                gpio_put(self->cs, 1);
-                spi_write_blocking(self->spi, FF, 1);
-            }
-            return self->token[0];
+    if (sdcard_wait(self, WAIT_R1, WAIT_CMD_US)) {
+        if (traced) traced->r1 = self->token[0];
+        for(int j=0; j<final; j++) spi_write_blocking(self->spi, FF, 1);
+        if (!hold){
+            gpio_put(self->cs, 1);
+            spi_write_blocking(self->spi, FF, 1);
         }
+        return self->token[0];
     }
     
     gpio_put(self->cs, 1);
@@ -152,7 +885,15 @@ STATIC int var_cmd_args(cmd_args in){
     uint8_t final             = in.final ? in.final : 0; 
     bool hold                 = in.hold  ? in.hold  : false; //I had to reverse the concept here
     bool skip                 = in.skip  ? in.skip  : false;
-    return sdcard_cmd_base(self, cmd, arg, crc, final, hold, skip);
+    int r = sdcard_cmd_base(self, cmd, arg, crc, final, hold, skip);
+    
+    //a command garbled on the way in is just sent again
+    for (int i = 0; self->crc.enabled && (r > 0) && (r & COM_CRC_ERROR) && (i < CRC_RETRIES); i++) {
+        self->crc.retries++;
+        self->stats.retries++;
+        r = sdcard_cmd_base(self, cmd, arg, crc, final, hold, skip);
+    }
+    return r;
 }
 
 //proxy that applies default arguments
@@ -185,108 +926,306 @@ STATIC void sdcard_init_v2(sdcard_SDObject_obj_t *self) {
     mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Timeout SDCard v2"));
 }
 
-STATIC void sdcard_readinto(sdcard_SDObject_obj_t *self, uint8_t *csd, int len) {
-    gpio_put(self->cs, 0);
-    
-    bool check = false;
+//__> DMA _____________________________________________________________________________________
+//TX streams a constant from a non-incrementing source into the SSP FIFO, RX drains the FIFO
+STATIC const uint8_t dma_ff = 0xFF;
+STATIC uint8_t       dma_sink;
+
+#if SDCARD_HAL_DMA
+STATIC void sdcard_dma_init(sdcard_SDObject_obj_t *self) {
+    self->dma_tx = dma_claim_unused_channel(false);
+    self->dma_rx = dma_claim_unused_channel(false);
     
-    for (int i=0; i<CMD_TIMEOUT; i++){
-        spi_read_blocking(self->spi, 0xFF, self->token, 1);
-        if (self->token[0] == TOKEN_DATA) {
-            check = true;
-            break;
-        }
-        sleep_ms(1);
+    //not enough free channels ~ fall back to blocking transfers
+    if (self->dma_tx < 0 || self->dma_rx < 0) {
+        if (self->dma_tx > -1) dma_channel_unclaim(self->dma_tx);
+        if (self->dma_rx > -1) dma_channel_unclaim(self->dma_rx);
+        self->dma_tx = self->dma_rx = -1;
     }
+}
+
+STATIC void sdcard_dma_deinit(sdcard_SDObject_obj_t *self) {
+    if (self->dma_tx < 0) return;
+    dma_channel_unclaim(self->dma_tx);
+    dma_channel_unclaim(self->dma_rx);
+    self->dma_tx = self->dma_rx = -1;
+}
+
+STATIC void sdcard_dma_start(sdcard_SDObject_obj_t *self, const uint8_t *src, uint8_t *dst, int len) {
+    spi_hw_t *hw  = spi_get_hw(self->spi);
+    bool      spi1_inst = spi_get_index(self->spi);
     
-    if(!check) {
-        gpio_put(self->cs, 1);
-        mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Response Timeout"));
-    }
+    dma_channel_config c = dma_channel_get_default_config(self->dma_tx);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, src != &dma_ff);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, spi1_inst ? DREQ_SPI1_TX : DREQ_SPI0_TX);
+    channel_config_set_sniff_enable(&c, self->crc.enabled && src != &dma_ff);
+    dma_channel_configure(self->dma_tx, &c, &hw->dr, src, len, false);
     
-    slice_obj_t b = slice(self->buffer, len, 0, len);
+    c = dma_channel_get_default_config(self->dma_rx);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, dst != &dma_sink);
+    channel_config_set_dreq(&c, spi1_inst ? DREQ_SPI1_RX : DREQ_SPI0_RX);
+    channel_config_set_sniff_enable(&c, self->crc.enabled && dst != &dma_sink);
+    dma_channel_configure(self->dma_rx, &c, dst, &hw->dr, len, false);
     
-    spi_write_read_blocking(self->spi, b.buff, csd, len);
+    //the sniffer checksums whichever side carries the packet while it moves
+    if (self->crc.enabled) {
+        dma_sniffer_enable((src != &dma_ff)? self->dma_tx : self->dma_rx, SNIFF_CRC16, false);
+        dma_hw->sniff_data = 0;
+        self->crc.sniff = true;
+    }
     
-    spi_write_blocking(self->spi, FF, 1);
-    spi_write_blocking(self->spi, FF, 1);
-    gpio_put(self->cs, 1);
-    spi_write_blocking(self->spi, FF, 1);
+    //start both together so the RX FIFO never overruns
+    dma_start_channel_mask((1u << self->dma_tx) | (1u << self->dma_rx));
 }
 
-STATIC void sdcard_write_token(sdcard_SDObject_obj_t *self, uint8_t token){
-    gpio_put(self->cs, 0);
-    
-    spi_read_blocking(self->spi, token, self->token, 1);
-    spi_write_blocking(self->spi, FF, 1);
-    
-    // wait for write to finish
-    spi_read_blocking(self->spi, 0xFF, self->token, 1);
-    while (!self->token[0])
-        spi_read_blocking(self->spi, 0xFF, self->token, 1);
+//RX finishing means every byte has been clocked
+STATIC void sdcard_dma_wait(sdcard_SDObject_obj_t *self) {
+    dma_channel_wait_for_finish_blocking(self->dma_rx);
+}
+#else
+//no DMA engine ~ the channels stay unclaimed, so every transfer takes the blocking path
+STATIC void sdcard_dma_init(sdcard_SDObject_obj_t *self) {
+    self->dma_tx = self->dma_rx = -1;
+}
 
-    gpio_put(self->cs, 1);
-    spi_write_blocking(self->spi, FF, 1);
+STATIC void sdcard_dma_deinit(sdcard_SDObject_obj_t *self) {
+    (void)self;
 }
 
-STATIC void sdcard_write(sdcard_SDObject_obj_t *self, uint8_t token, uint8_t *buf, int len){
-        gpio_put(self->cs, 0);
+STATIC void sdcard_dma_start(sdcard_SDObject_obj_t *self, const uint8_t *src, uint8_t *dst, int len) {
+    if (src == &dma_ff) spi_read_blocking(self->spi, 0xFF, dst, len);
+    else                spi_write_blocking(self->spi, src, len);
+}
 
-        // send: start of block, data, checksum
-        spi_read_blocking(self->spi, token, self->token, 1);
-        spi_write_blocking(self->spi, buf, len);
-        spi_write_blocking(self->spi, FF, 1);
-        spi_write_blocking(self->spi, FF, 1);
+STATIC void sdcard_dma_wait(sdcard_SDObject_obj_t *self) {
+    (void)self;
+}
+#endif
 
-        // check the response
-        spi_read_blocking(self->spi, 0xFF, self->token, 1);
-        
-        if ((self->token[0] & 0x1F) != 0x05) {
-            gpio_put(self->cs, 1);
-            spi_write_blocking(self->spi, FF, 1);
-            return;
-        }
+STATIC void sdcard_dma_xfer(sdcard_SDObject_obj_t *self, const uint8_t *src, uint8_t *dst, int len) {
+    sdcard_dma_start(self, src, dst, len);
+    sdcard_dma_wait(self);
+}
 
-        // wait for write to finish
-        spi_read_blocking(self->spi, 0xFF, self->token, 1);
-        while (!self->token[0])
-            spi_read_blocking(self->spi, 0xFF, self->token, 1);
+//data phase of a block ~ tokens and checksum bytes stay on the CPU
+STATIC void sdcard_data_read(sdcard_SDObject_obj_t *self, uint8_t *buf, int len) {
+    uint64_t t = time_us_64();
+    if (self->dma_rx > -1) sdcard_dma_xfer(self, &dma_ff, buf, len);
+    else                   spi_read_blocking(self->spi, 0xFF, buf, len);
+    self->stats.xfer_us += time_us_64() - t;
+    if (self->trace.capacity) sdcard_trace_data(self, len);
+}
 
-        gpio_put(self->cs, 1);
-        spi_write_blocking(self->spi, FF, 1);
+STATIC void sdcard_data_write(sdcard_SDObject_obj_t *self, const uint8_t *buf, int len) {
+    uint64_t t = time_us_64();
+    if (self->dma_tx > -1) sdcard_dma_xfer(self, buf, &dma_sink, len);
+    else                   spi_write_blocking(self->spi, buf, len);
+    self->stats.xfer_us += time_us_64() - t;
+    if (self->trace.capacity) sdcard_trace_data(self, len);
 }
 
 
-STATIC mp_obj_t SDObject_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
-    mp_arg_check_num(n_args, n_kw, 0, 4, true);
-    sdcard_SDObject_obj_t *self = m_new_obj(sdcard_SDObject_obj_t);
-    self->base.type = &sdcard_SDObject_type;
-    
-    enum {ARG_spi, ARG_cs, ARG_baudrate, ARG_led};
-    static const mp_arg_t allowed_args[] = {
-        { MP_QSTR_spi       , MP_ARG_REQUIRED | MP_ARG_INT , {.u_int     = 0       }},
-        { MP_QSTR_cs        , MP_ARG_REQUIRED | MP_ARG_INT , {.u_int     = 0       }},
-        { MP_QSTR_baudrate  , MP_ARG_INT                   , {.u_int     = 0x500000}}, //5 mb
-        { MP_QSTR_led       , MP_ARG_INT                   , {.u_int     = -1      }},
-    }; 
-    
-    mp_arg_val_t kw[MP_ARRAY_SIZE(allowed_args)];
-    mp_arg_parse_all_kw_array(n_args, n_kw, args, MP_ARRAY_SIZE(allowed_args), allowed_args, kw);
+//asserts CS and waits for the start of a data packet ~ a data error token fails at once
+STATIC void sdcard_data_token(sdcard_SDObject_obj_t *self) {
+    sdcard_select(self);
     
-    //setup spi
-    self->spi = (kw[ARG_spi].u_int == 0)? spi0 : spi1;
-    spi_init(self->spi, SPI_BAUDRATE);
-    spi_set_format(self->spi, SPI_BITS, SPI_POLARITY, SPI_PHASE, SPI_FIRSTBIT);
+    bool arrived = sdcard_wait(self, WAIT_TOKEN, self->wait.token_us);
+    if (arrived && self->token[0] == TOKEN_DATA) return;
     
-    self->token[0] = 0x00;
-    for(int i=0; i<BLOCK; i++) self->buffer[i] = 0xFF;     
+    gpio_put(self->cs, 1);
+    sdcard_raise(arrived ? 5 : ERR_RESPONSE);
+}
 
-    //setup chip-select pin
+//ends a data packet ~ `hold` keeps CS asserted for the next block of a run. false means buf failed its CRC
+STATIC bool sdcard_data_end(sdcard_SDObject_obj_t *self, const uint8_t *buf, int len, bool hold) {
+    uint8_t sum[2];
+    spi_read_blocking(self->spi, 0xFF, sum, 2);
+    
+    if (!hold) {
+        gpio_put(self->cs, 1);
+        spi_write_blocking(self->spi, FF, 1);
+    }
+    
+    if (!self->crc.enabled) return true;
+    if (sdcard_crc16(self, buf, len) == ((sum[0] << 8) | sum[1])) return true;
+    
+    self->crc.errors++;
+    return false;
+}
+
+//reads a data packet straight into the caller's memory ~ false means it failed its CRC
+STATIC bool sdcard_readinto(sdcard_SDObject_obj_t *self, uint8_t *buf, int len, bool hold) {
+    sdcard_data_token(self);
+    
+    //clock 0xFF out while the data lands directly in buf
+    sdcard_data_read(self, buf, len);
+    
+    return sdcard_data_end(self, buf, len, hold);
+}
+
+//counts one more attempt at a block that failed its CRC ~ raises once CRC_RETRIES are used up
+STATIC bool sdcard_crc_again(sdcard_SDObject_obj_t *self, int *tries) {
+    if (++(*tries) > CRC_RETRIES) sdcard_raise(5);
+    self->crc.retries++;
+    self->stats.retries++;
+    return true;
+}
+
+//reads one block on its own with CMD17 until it passes its CRC
+STATIC void sdcard_read_retry(sdcard_SDObject_obj_t *self, uint32_t blocknum, uint8_t *buf) {
+    int tries = 0;
+    do {
+        if (sdcard_cmd(self, CMD17, blocknum*self->cdv, .hold=true)) {
+            gpio_put(self->cs, 1);
+            sdcard_raise(5);
+        }
+    } while (!sdcard_readinto(self, buf, BLOCK, false) && sdcard_crc_again(self, &tries));
+}
+
+STATIC void sdcard_write_token(sdcard_SDObject_obj_t *self, uint8_t token){
+    if (self->trace.capacity) sdcard_trace_cmd(self, token, 0);
+    sdcard_select(self);
+    
+    spi_read_blocking(self->spi, token, self->token, 1);
+    spi_write_blocking(self->spi, FF, 1);
+    
+    // wait for write to finish (or leave it to the next command)
+    sdcard_busy_end(self);
+}
+
+//sends one data packet and returns the data response ~ CS stays asserted only if the card accepted it
+STATIC int sdcard_write_packet(sdcard_SDObject_obj_t *self, uint8_t token, const uint8_t *buf, int len){
+        sdcard_select(self);
+
+        // send: start of block, data, checksum
+        spi_read_blocking(self->spi, token, self->token, 1);
+        sdcard_data_write(self, buf, len);
+        
+        if (self->crc.enabled) {
+            uint16_t crc = sdcard_crc16(self, buf, len);
+            spi_write_blocking(self->spi, (uint8_t []){crc >> 8, crc & 0xFF}, 2);
+        } else {
+            spi_write_blocking(self->spi, FF, 1);
+            spi_write_blocking(self->spi, FF, 1);
+        }
+
+        // check the response
+        spi_read_blocking(self->spi, 0xFF, self->token, 1);
+        
+        int response = self->token[0] & 0x1F;
+        if (response != DATA_ACCEPTED) {
+            if (response == DATA_CRC_ERROR) self->crc.errors++;
+            gpio_put(self->cs, 1);
+            spi_write_blocking(self->spi, FF, 1);
+        }
+        
+        return response;
+}
+
+//sends one data packet from the caller's memory ~ `hold` keeps CS asserted for the next block of a run. returns the data response
+//only DATA_CRC_ERROR comes back for a retry ~ a write error, or anything else, ends the run and raises
+STATIC int sdcard_write(sdcard_SDObject_obj_t *self, uint8_t token, const uint8_t *buf, int len, bool hold){
+        int response = sdcard_write_packet(self, token, buf, len);
+        if (response == DATA_CRC_ERROR) return response;
+        if (response != DATA_ACCEPTED) {
+            if (token == TOKEN_CMD25) sdcard_write_token(self, TOKEN_STOP_TRAN);
+            sdcard_raise(5);
+        }
+
+        // wait for write to finish ~ only the end of a transaction can leave it to the next command
+        if (!hold) sdcard_busy_end(self);
+        else       sdcard_wait_busy(self, self->wait.busy_us);
+        
+        return response;
+}
+
+
+//AU_SIZE codes 1..F in blocks ~ 16 KB doubling to 4 MB, then 8, 12, 16, 24, 32 and 64 MB
+STATIC const uint32_t au_blocks[16] = {
+    AU_DEFAULT, 0x20, 0x40, 0x80, 0x100, 0x200, 0x400, 0x800, 
+    0x1000, 0x2000, 0x4000, 0x6000, 0x8000, 0xC000, 0x10000, 0x20000
+};
+
+//TRAN_SPEED time values x10 ~ 0 is reserved
+STATIC const uint8_t tran_values[16] = {0, 10, 12, 13, 15, 20, 25, 30, 35, 40, 45, 50, 55, 60, 70, 80};
+
+STATIC uint32_t sdcard_clock_auto(sdcard_SDObject_obj_t *self);
+STATIC void sdcard_worker_start(sdcard_SDObject_obj_t *self);
+
+STATIC mp_obj_t SDObject_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 0, 14, true);
+    sdcard_SDObject_obj_t *self = m_new_obj_with_finaliser(sdcard_SDObject_obj_t);
+    self->base.type = &sdcard_SDObject_type;
+    
+    enum {ARG_spi, ARG_cs, ARG_baudrate, ARG_led, ARG_dma, ARG_cache, ARG_ways, ARG_prefetch, ARG_pin, ARG_coalesce, ARG_flush_ms, ARG_crc, ARG_worker, ARG_trace};
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_spi       , MP_ARG_REQUIRED | MP_ARG_INT , {.u_int     = 0       }},
+        { MP_QSTR_cs        , MP_ARG_REQUIRED | MP_ARG_INT , {.u_int     = 0       }},
+        { MP_QSTR_baudrate  , MP_ARG_OBJ                   , {.u_obj     = MP_OBJ_NULL}}, //int or 'auto' ~ BAUD_DEFAULT when omitted
+        { MP_QSTR_led       , MP_ARG_INT                   , {.u_int     = -1      }},
+        { MP_QSTR_dma       , MP_ARG_BOOL                  , {.u_bool    = false   }},
+        { MP_QSTR_cache     , MP_ARG_INT                   , {.u_int     = 0       }}, //lines of BLOCK bytes
+        { MP_QSTR_ways      , MP_ARG_INT                   , {.u_int     = 4       }},
+        { MP_QSTR_prefetch  , MP_ARG_INT                   , {.u_int     = 0       }}, //read-ahead budget in bytes
+        { MP_QSTR_pin       , MP_ARG_INT                   , {.u_int     = 0       }}, //lines reserved for FAT metadata
+        { MP_QSTR_coalesce  , MP_ARG_INT                   , {.u_int     = 0       }}, //blocks gathered into one CMD25
+        { MP_QSTR_flush_ms  , MP_ARG_INT                   , {.u_int     = 100     }},
+        { MP_QSTR_crc       , MP_ARG_BOOL                  , {.u_bool    = false   }},
+        { MP_QSTR_worker    , MP_ARG_BOOL                  , {.u_bool    = false   }}, //run card traffic on core1
+        { MP_QSTR_trace     , MP_ARG_INT                   , {.u_int     = 0       }}, //commands kept in the trace ring
+    }; 
+    
+    mp_arg_val_t kw[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all_kw_array(n_args, n_kw, args, MP_ARRAY_SIZE(allowed_args), allowed_args, kw);
+    
+    mp_obj_t baud = kw[ARG_baudrate].u_obj;
+    bool autobaud = (baud != MP_OBJ_NULL) && mp_obj_is_str(baud);
+    if (autobaud && strcmp(mp_obj_str_get_str(baud), "auto") != 0) 
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid Baudrate"));
+    
+    //setup chip-select pin ~ before anything clocks, so a card already on the bus can't hear this one's init
     self->cs  = kw[ARG_cs].u_int;
     gpio_set_function(self->cs, GPIO_FUNC_SIO);
     gpio_set_dir(self->cs, GPIO_OUT);
     gpio_put(self->cs, 1);
     
+    //setup spi ~ the init clock stays this card's until it is negotiated
+    self->spi      = (kw[ARG_spi].u_int == 0)? spi0 : spi1;
+    self->baudrate = SPI_BAUDRATE;
+    sdcard_bus_attach(self, kw[ARG_spi].u_int != 0);
+    sdcard_bus_use(self);
+    
+    //a card that fails to come up gives its place on the bus back ~ else it counts toward BUS_DEVICES and blocks the worker
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) != 0) {
+        gpio_put(self->cs, 1);
+        sdcard_dma_deinit(self);
+        sdcard_bus_detach(self);
+        nlr_jump(nlr.ret_val);
+    }
+    
+    self->token[0] = 0x00;
+    self->dma_tx   = self->dma_rx = -1;
+    memset(&self->crc, 0, sizeof(self->crc));
+    memset(&self->stats, 0, sizeof(self->stats));
+    sdcard_trace_init(&self->trace, kw[ARG_trace].u_int);
+    sdcard_wait_init(&self->wait);
+    self->stream   = NULL;
+    self->aio      = NULL;
+    self->logger   = NULL;
+    self->worker   = NULL;
+    self->cache.lines = 0;
+    self->prefetch.capacity = 0;
+    self->pinned.lines = 0;
+    self->pin_count[0] = self->pin_count[1] = 0;
+    self->queue.capacity = 0;
+    self->queue.alarm    = 0;
+    self->erase_count    = 0;
+    
     self->led = kw[ARG_led].u_int;
     if (self->led > -1) {
         gpio_set_function(self->led, GPIO_FUNC_SIO); 
@@ -294,137 +1233,2381 @@ STATIC mp_obj_t SDObject_make_new(const mp_obj_type_t *type, size_t n_args, size
         gpio_put(self->led, 0);
     }
     
-    for(int i=0; i < 16; i++) spi_write_blocking(self->spi, FF, 1);
+    for(int i=0; i < 16; i++) spi_write_blocking(self->spi, FF, 1);
+    
+    bool found = false;
+    for (int i=0; i < 5; i++) {
+        if (sdcard_cmd(self, CMD0, 0, 0x95) == IDLE_STATE) {
+            found = true;
+            break;
+        }
+    }
+    
+    if (!found) mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("No Card")); 
+    
+    int r1 = sdcard_cmd(self, CMD8, 0x0001AA, 0x87, 4);
+    
+    if      (r1 == IDLE_STATE)                  sdcard_init_v2(self);
+    else if (r1 == (IDLE_STATE | ILLEGAL_CMD))  sdcard_init_v1(self);
+    else    mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Unknown Version"));
+    
+    if (sdcard_cmd(self, CMD9, .hold=true)) mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("No Response"));
+            
+    uint8_t csd[16] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
+    sdcard_readinto(self, csd, 16, false);
+    
+    if ((csd[0] & 0xC0) == 0x40) self->sectors = ((csd[8] << 8 | csd[9]) + 1) * 1024;   // CSD version 2.0
+    else if ((csd[0] & 0xC0) == 0x00) {                                                 // CSD version 1.0 (old, <=2GB)
+        uint16_t c_size       = (csd[6] & 0x3) | (csd[7] << 2) | ((csd[8] & 0xC0) << 4);
+        uint16_t c_size_mult  = ((csd[9] & 0x3) << 1) | (csd[10] >> 7);
+        self->sectors = (c_size + 1) * pow(2, (c_size_mult + 2));
+    }
+    else mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("CSD Format Unsupported"));
+    
+    //TRAN_SPEED ~ rate unit in bits 2:0 (100 kbit/s * 10^n), time value in bits 6:3
+    self->tran_speed = ((csd[3] & 0x07) < 4)? tran_values[(csd[3] >> 3) & 0x0F] * 10000 * (uint32_t)pow(10, csd[3] & 0x07) : 0;
+    if (!self->tran_speed) self->tran_speed = 25000000;
+    self->hs = false;
+        
+     
+    if (sdcard_cmd(self, CMD16, BLOCK) != 0) mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Can't Set Block Size"));
+    
+    //CRC ~ from here on every command carries a real CRC7 and every data packet a CRC16
+    if (kw[ARG_crc].u_bool) {
+        if (sdcard_cmd(self, CMD59, 1) != 0) mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Can't Enable CRC"));
+        self->crc.enabled = true;
+    }
+    
+    //SCR ~ v1 cards and readers that refuse ACMD51 just keep open-ended runs
+    self->scr_cmd23 = false;
+    sdcard_cmd(self, CMD55);
+    if (sdcard_cmd(self, CMD51, .hold=true) == 0) {
+        uint8_t scr[8];
+        sdcard_readinto(self, scr, 8, false);
+        self->scr_cmd23 = (scr[3] & 0x02);
+    } else {
+        gpio_put(self->cs, 1);
+        spi_write_blocking(self->spi, FF, 1);
+    }
+    self->cmd23 = self->scr_cmd23;
+    
+    //SD status ~ erases are split on allocation unit boundaries
+    self->au = AU_DEFAULT;
+    sdcard_cmd(self, CMD55);
+    if (sdcard_cmd(self, CMD13, .final=1, .hold=true) == 0) {
+        uint8_t status[64];
+        sdcard_readinto(self, status, 64, false);
+        if (status[10] >> 4) self->au = au_blocks[status[10] >> 4];
+    } else {
+        gpio_put(self->cs, 1);
+        spi_write_blocking(self->spi, FF, 1);
+    }
+
+    //high speed is only worth asking for when the clock will be tuned to use it
+    if (autobaud && (((csd[4] << 4) | (csd[5] >> 4)) & 0x400)) {
+        uint8_t status[64];
+        
+        //check mode ~ is function 1 of group 1 supported
+        if (sdcard_cmd(self, CMD6, 0x00FFFFF1, .hold=true) == 0) {
+            sdcard_readinto(self, status, 64, false);
+            
+            //switch mode ~ the card answers with the function it actually selected
+            if ((status[13] & 0x02) && sdcard_cmd(self, CMD6, 0x80FFFFF1, .hold=true) == 0) {
+                sdcard_readinto(self, status, 64, false);
+                if ((status[16] & 0x0F) == 0x01) {
+                    self->hs = true;
+                    self->tran_speed = BAUD_HS;
+                }
+            }
+        } else {
+            gpio_put(self->cs, 1);
+            spi_write_blocking(self->spi, FF, 1);
+        }
+    }
+    
+    if (autobaud) self->baudrate = sdcard_clock_auto(self);
+    else          sdcard_clock_set(self, (baud == MP_OBJ_NULL)? BAUD_DEFAULT : mp_obj_get_int(baud));
+    
+    //claimed last so a failed init doesn't leave channels behind
+    if (kw[ARG_dma].u_bool) sdcard_dma_init(self);
+    
+    sdcard_cache_init(&self->cache, kw[ARG_cache].u_int, kw[ARG_ways].u_int);
+    sdcard_prefetch_init(&self->prefetch, kw[ARG_prefetch].u_int);
+    sdcard_cache_init(&self->pinned, kw[ARG_pin].u_int, 8);
+    self->pinned.keep = true;
+    sdcard_queue_init(&self->queue, kw[ARG_coalesce].u_int, kw[ARG_flush_ms].u_int);
+    
+    //started once everything it touches exists
+    self->use_worker = kw[ARG_worker].u_bool;
+    if (self->use_worker) sdcard_worker_start(self);
+    nlr_pop();
+    
+    //mp_printf(MP_PYTHON_PRINTER, "card ready\n");
+    return MP_OBJ_FROM_PTR(self);
+}
+
+STATIC void sdcard_indicate(sdcard_SDObject_obj_t *self, bool on) {
+    if (self->led > -1) gpio_put(self->led, on);
+}
+
+
+//__> STREAM _____________________________________________________________________________________
+//CMD18 reader that hands out block N while block N+1 is already being clocked into the other buffer
+const mp_obj_type_t sdcard_SDStream_type;
+
+STATIC void sdcard_io_sync(sdcard_SDObject_obj_t *self);
+
+typedef struct _sdcard_SDStream_obj_t {
+    mp_obj_base_t base;
+    sdcard_SDObject_obj_t *sd;
+    uint32_t  remaining;    //blocks not handed out yet
+    uint32_t  unread;       //blocks whose start token has not been seen yet
+    uint32_t  block;        //block number of the next block handed out
+    uint8_t   fill;         //ping-pong half that holds (or is receiving) the next block
+    bool      pending;      //a DMA transfer into bufs[fill] is in flight
+    bool      ready;        //bufs[fill] holds a complete block
+    bool      parked;       //another card on the bus took it ~ the run was ended and is restarted on the next call
+    mp_obj_t  views[2];
+    uint8_t   bufs[2][BLOCK];
+} sdcard_SDStream_obj_t;
+
+//the next block failed its CRC ~ end the run, read that block alone and restart the run behind it
+STATIC void sdcard_stream_repair(sdcard_SDStream_obj_t *self, uint8_t *buf) {
+    sdcard_SDObject_obj_t *sd = self->sd;
+    if (sdcard_cmd(sd, CMD12, 0, 0xFF, .skip=true)) mp_raise_OSError(5);
+    
+    sdcard_read_retry(sd, self->block, buf);
+    
+    if (self->unread && sdcard_cmd(sd, CMD18, (self->block + 1)*sd->cdv, .hold=true)) {
+        gpio_put(sd->cs, 1);
+        mp_raise_OSError(5);
+    }
+}
+
+//wait for the next start token and begin moving that block into the free half
+STATIC void sdcard_stream_fetch(sdcard_SDStream_obj_t *self) {
+    sdcard_SDObject_obj_t *sd = self->sd;
+    sdcard_data_token(sd);
+    self->unread--;
+    
+    if (sd->dma_rx > -1) {
+        sdcard_dma_start(sd, &dma_ff, self->bufs[self->fill], BLOCK);
+        self->pending = true;
+    } else {
+        spi_read_blocking(sd->spi, 0xFF, self->bufs[self->fill], BLOCK);
+        if (!sdcard_data_end(sd, self->bufs[self->fill], BLOCK, true)) sdcard_stream_repair(self, self->bufs[self->fill]);
+        self->ready = true;
+    }
+}
+
+//completes the block in bufs[fill]
+STATIC void sdcard_stream_land(sdcard_SDStream_obj_t *self) {
+    if (self->pending) {
+        sdcard_dma_wait(self->sd);
+        self->pending = false;
+        if (!sdcard_data_end(self->sd, self->bufs[self->fill], BLOCK, true)) sdcard_stream_repair(self, self->bufs[self->fill]);
+        self->ready   = true;
+    }
+}
+
+STATIC void sdcard_stream_close(sdcard_SDStream_obj_t *self) {
+    sdcard_SDObject_obj_t *sd = self->sd;
+    if (sd == NULL) return;
+    
+    //a started packet has to be clocked out before the card will listen
+    if (self->pending) sdcard_dma_wait(sd);
+    bool parked     = self->parked;
+    self->pending   = self->ready = self->parked = false;
+    self->remaining = self->unread = 0;
+    self->sd        = NULL;
+    sd->stream      = NULL;
+    
+    if (!parked && sdcard_cmd(sd, CMD12, 0, 0xFF, .skip=true)) mp_raise_OSError(5);
+}
+
+//another card wants the bus ~ the block in flight is finished so the run can restart on a block boundary
+STATIC void sdcard_stream_park(sdcard_SDObject_obj_t *sd) {
+    sdcard_SDStream_obj_t *self = sd->stream;
+    if (self == NULL || self->parked) return;
+    
+    sdcard_stream_land(self);
+    self->parked = true;
+    if (sdcard_cmd(sd, CMD12, 0, 0xFF, .skip=true)) mp_raise_OSError(5);
+}
+
+//restarts a parked run at the first block the card hasn't sent yet ~ one that was already fully received stays parked
+STATIC void sdcard_stream_resume(sdcard_SDStream_obj_t *self) {
+    if (!self->parked || !self->unread) return;
+    sdcard_SDObject_obj_t *sd = self->sd;
+    self->parked = false;
+    
+    if (sdcard_cmd(sd, CMD18, (self->block + self->remaining - self->unread)*sd->cdv, .hold=true)) {
+        gpio_put(sd->cs, 1);
+        mp_raise_OSError(5);
+    }
+}
+
+//returns the index of the buffer that holds the next block ~ `ahead` starts fetching the one after it
+STATIC int sdcard_stream_next(sdcard_SDStream_obj_t *self, bool ahead) {
+    if (!self->pending && !self->ready) sdcard_stream_fetch(self);
+    sdcard_stream_land(self);
+    
+    int out = self->fill;
+    self->ready = false;
+    self->remaining--;
+    self->block++;
+    self->fill ^= 1;
+    
+    if (ahead && self->unread) sdcard_stream_fetch(self);
+    return out;
+}
+
+//other traffic has to end an open stream first ~ and a logger's open run, whose ring keeps its blocks
+STATIC void sdcard_stream_release(sdcard_SDObject_obj_t *self) {
+    if (self->stream != NULL) sdcard_stream_close(self->stream);
+    sdcard_logger_park(self);
+}
+
+STATIC mp_obj_t SDObject_stream(mp_obj_t self_in, mp_obj_t start_obj, mp_obj_t count_obj) {
+    sdcard_SDObject_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    sdcard_check_idle(self);
+    mp_int_t start = mp_obj_get_int(start_obj);
+    mp_int_t count = mp_obj_get_int(count_obj);
+    if (start < 0 || count < 1 || (uint64_t)(start + count) > self->sectors) 
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid Block Range"));
+    
+    //the stream reads the card directly ~ cached writes have to land first
+    sdcard_io_sync(self);
+    
+    sdcard_SDStream_obj_t *stream = m_new_obj(sdcard_SDStream_obj_t);
+    stream->base.type = &sdcard_SDStream_type;
+    stream->sd        = self;
+    stream->remaining = stream->unread = count;
+    stream->block     = start;
+    stream->fill      = 0;
+    stream->pending   = stream->ready  = stream->parked = false;
+    stream->views[0]  = mp_obj_new_memoryview('B', BLOCK, stream->bufs[0]);
+    stream->views[1]  = mp_obj_new_memoryview('B', BLOCK, stream->bufs[1]);
+    
+    if (sdcard_cmd(self, CMD18, start*self->cdv, .hold=true)) {
+        gpio_put(self->cs, 1);
+        mp_raise_OSError(5);
+    }
+    
+    self->stream = stream;
+    sdcard_indicate(self, true);
+    sdcard_stream_fetch(stream);
+    return MP_OBJ_FROM_PTR(stream);
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(SDObject_stream_obj, SDObject_stream);
+
+//the view is refilled by the following advance ~ consume or copy it before asking for the next block
+STATIC mp_obj_t SDStream_iternext(mp_obj_t self_in) {
+    sdcard_SDStream_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->sd == NULL) return MP_OBJ_STOP_ITERATION;
+    sdcard_check_idle(self->sd);
+    sdcard_stream_resume(self);
+    
+    int out = sdcard_stream_next(self, true);
+    if (!self->remaining) {
+        sdcard_indicate(self->sd, false);
+        sdcard_stream_close(self);
+    }
+    
+    return self->views[out];
+}
+
+//fills buf with whole blocks and returns the number of bytes written to it ~ 0 once the stream is exhausted
+STATIC mp_obj_t SDStream_readinto(mp_obj_t self_in, mp_obj_t buf) {
+    sdcard_SDStream_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buf, &bufinfo, MP_BUFFER_WRITE);
+    
+    if (self->sd == NULL) return MP_OBJ_NEW_SMALL_INT(0);
+    sdcard_check_idle(self->sd);
+    sdcard_stream_resume(self);
+    
+    sdcard_SDObject_obj_t *sd  = self->sd;
+    uint8_t  *dst    = bufinfo.buf;
+    uint32_t  nblocks = bufinfo.len / BLOCK;
+    if (!nblocks) mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid Buffer Length"));
+    if (nblocks > self->remaining) nblocks = self->remaining;
+    
+    uint32_t i = 0;
+    
+    //only the block already in flight goes through the ping-pong buffer
+    if (self->pending || self->ready) {
+        memcpy(dst, self->bufs[sdcard_stream_next(self, false)], BLOCK);
+        i++;
+    }
+    
+    //the rest lands directly in the caller's memory
+    for (; i < nblocks; i++) {
+        bool ok = sdcard_readinto(sd, dst + (i * BLOCK), BLOCK, true);
+        self->unread--;
+        if (!ok) sdcard_stream_repair(self, dst + (i * BLOCK));
+        self->remaining--;
+        self->block++;
+    }
+    
+    //re-prime the pipeline so the next block moves while the caller works
+    if (self->unread) sdcard_stream_fetch(self);
+    
+    if (!self->remaining) {
+        sdcard_indicate(sd, false);
+        sdcard_stream_close(self);
+    }
+    
+    return MP_OBJ_NEW_SMALL_INT(i * BLOCK);
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(SDStream_readinto_obj, SDStream_readinto);
+
+STATIC mp_obj_t SDStream_close(mp_obj_t self_in) {
+    sdcard_SDStream_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->sd != NULL) {
+        sdcard_indicate(self->sd, false);
+        sdcard_stream_close(self);
+    }
+    return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(SDStream_close_obj, SDStream_close);
+
+STATIC const mp_rom_map_elem_t SDStream_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_readinto), MP_ROM_PTR(&SDStream_readinto_obj) },
+    { MP_ROM_QSTR(MP_QSTR_close)   , MP_ROM_PTR(&SDStream_close_obj)    },
+};
+
+STATIC MP_DEFINE_CONST_DICT(SDStream_locals_dict, SDStream_locals_dict_table);
+
+const mp_obj_type_t sdcard_SDStream_type = {
+    { &mp_type_type },
+    .name        = MP_QSTR_SDStream,
+    .getiter     = mp_identity_getiter,
+    .iternext    = SDStream_iternext,
+    .locals_dict = (mp_obj_dict_t*)&SDStream_locals_dict,
+};
+
+
+//__> READ BLOCKS _____________________________________________________________________________________
+//announces the length of a multi-block run ~ false means the run stays open-ended and needs stopping
+STATIC bool sdcard_set_count(sdcard_SDObject_obj_t *self, uint32_t nblocks) {
+    if (!self->cmd23) return false;
+    if (sdcard_cmd(self, CMD23, nblocks) == 0) return true;
+    
+    //advertised but refused ~ don't try again
+    self->cmd23 = self->scr_cmd23 = false;
+    return false;
+}
+
+STATIC void sdcard_readblocks(sdcard_SDObject_obj_t *self, int blocknum, uint8_t *buf, int len) {
+    // mp_printf(MP_PYTHON_PRINTER, "readblocks\n");
+    uint64_t nblocks = len/BLOCK;
+    if ((!nblocks) || (len%BLOCK)) mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid Buffer Length"));
+    
+    sdcard_stream_release(self);
+    
+    if (nblocks == 1) {
+        if (sdcard_cmd(self, CMD17, blocknum*self->cdv, .hold=true)) {
+            gpio_put(self->cs, 1);
+            sdcard_raise(5);
+        }
+                
+        if (!sdcard_readinto(self, buf, BLOCK, false)) sdcard_read_retry(self, blocknum, buf);
+    }
+    else {
+        bool bounded = sdcard_set_count(self, nblocks);
+        
+        if (sdcard_cmd(self, CMD18, blocknum*self->cdv, .hold=true)) {
+            gpio_put(self->cs, 1);
+            sdcard_raise(5);
+        }
+            
+        //CS stays low for the whole run
+        for (int i=0; i<nblocks; i++) {
+            if (sdcard_readinto(self, buf + (i * BLOCK), BLOCK, true)) continue;
+            
+            //a bad block ends the run ~ it is read again alone and the rest restarts behind it
+            //a counted run may already be over when its last block is the bad one, so CMD12 can be refused
+            if (sdcard_cmd(self, CMD12, 0, 0xFF, .skip=true) && !bounded) sdcard_raise(5);
+            sdcard_read_retry(self, blocknum + i, buf + (i * BLOCK));
+            if (i + 1 < nblocks) sdcard_readblocks(self, blocknum + i + 1, buf + ((i + 1) * BLOCK), (nblocks - i - 1) * BLOCK);
+            return;
+        }
+        
+        //a counted run ends by itself ~ an open one needs CMD12
+        if (bounded) {
+            gpio_put(self->cs, 1);
+            spi_write_blocking(self->spi, FF, 1);
+        } 
+        else if (sdcard_cmd(self, CMD12, 0, 0xFF, .skip=true)) sdcard_raise(5);
+    }
+    
+}
+
+//__> WRITE BLOCKS _____________________________________________________________________________________
+STATIC void sdcard_writeblocks(sdcard_SDObject_obj_t *self, int blocknum, const uint8_t *buf, int len) {
+    //mp_printf(MP_PYTHON_PRINTER, "writeblocks\n");
+    uint64_t nblocks = len/BLOCK;
+    if ((!nblocks) || (len%BLOCK)) mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid Buffer Length"));
+    
+    sdcard_stream_release(self);
+    
+    int tries = 0;
+    
+    if (nblocks == 1) {
+        do {
+            if (sdcard_cmd(self, CMD24, blocknum*self->cdv)) sdcard_raise(5);
+        } while (sdcard_write(self, TOKEN_DATA, buf, len, false) == DATA_CRC_ERROR && sdcard_crc_again(self, &tries));
+    }
+    else while (nblocks) {
+        bool bounded = sdcard_set_count(self, nblocks);
+        
+        //ACMD23 lets the card erase ahead of an open-ended run ~ a refusal costs nothing
+        if (!bounded && nblocks >= PRE_ERASE_MIN) {
+            sdcard_cmd(self, CMD55);
+            sdcard_cmd(self, CMD23, nblocks);
+        }
+        
+        if (sdcard_cmd(self, CMD25, blocknum*self->cdv)) sdcard_raise(5);
+        
+        //a counted run ends by itself after its last block ~ that block ends the transaction
+        uint32_t i = 0;
+        for (; i<nblocks; i++)
+            if (sdcard_write(self, TOKEN_CMD25, buf + (i * BLOCK), BLOCK, !(bounded && i == nblocks - 1)) == DATA_CRC_ERROR) break;
+        
+        //an open run, or one cut short, needs the stop token
+        if (!bounded || i < nblocks) sdcard_write_token(self, TOKEN_STOP_TRAN);
+        
+        if (i == nblocks) break;
+        
+        //the card dropped a block for its CRC ~ send it again with everything behind it
+        sdcard_crc_again(self, &tries);
+        blocknum += i;
+        buf      += i * BLOCK;
+        nblocks  -= i;
+    }
+}
+
+//__> VECTORED _____________________________________________________________________________________
+//segments that continue each other from seg[0] ~ returns how many, and their blocks through `nblocks`
+STATIC uint32_t sdcard_seg_run(const sdcard_seg_t *seg, uint32_t nsegs, uint32_t *nblocks) {
+    uint32_t n = 1;
+    *nblocks = seg[0].nblocks;
+    while (n < nsegs && seg[n].block == seg[0].block + *nblocks) *nblocks += seg[n++].nblocks;
+    return n;
+}
+
+//drops the first `done` blocks of a run ~ returns the segment the rest starts in, trimmed to where it starts
+STATIC uint32_t sdcard_seg_skip(sdcard_seg_t *seg, uint32_t done) {
+    uint32_t s = 0;
+    while (done >= seg[s].nblocks) done -= seg[s++].nblocks;
+    seg[s].block   += done;
+    seg[s].buf     += done * BLOCK;
+    seg[s].nblocks -= done;
+    return s;
+}
+
+//one CMD18 across segments that continue each other ~ every block lands in its own caller's memory
+STATIC void sdcard_readv_run(sdcard_SDObject_obj_t *self, sdcard_seg_t *seg, uint32_t nsegs) {
+    uint32_t nblocks;
+    sdcard_seg_run(seg, nsegs, &nblocks);
+    if (nsegs == 1) {
+        sdcard_readblocks(self, seg->block, seg->buf, seg->nblocks * BLOCK);
+        return;
+    }
+    
+    sdcard_stream_release(self);
+    bool bounded = sdcard_set_count(self, nblocks);
+    
+    if (sdcard_cmd(self, CMD18, seg->block*self->cdv, .hold=true)) {
+        gpio_put(self->cs, 1);
+        sdcard_raise(5);
+    }
+    
+    uint32_t s = 0, at = 0;
+    for (uint32_t i = 0; i < nblocks; i++) {
+        uint8_t *buf = seg[s].buf + (at * BLOCK);
+        if (++at == seg[s].nblocks) { s++; at = 0; }
+        if (sdcard_readinto(self, buf, BLOCK, true)) continue;
+        
+        //same recovery as sdcard_readblocks ~ the bad block alone, then a new run from the segment it belonged to
+        if (sdcard_cmd(self, CMD12, 0, 0xFF, .skip=true) && !bounded) sdcard_raise(5);
+        sdcard_read_retry(self, seg->block + i, buf);
+        if (i + 1 < nblocks) {
+            s = sdcard_seg_skip(seg, i + 1);
+            sdcard_readv_run(self, seg + s, nsegs - s);
+        }
+        return;
+    }
+    
+    if (bounded) {
+        gpio_put(self->cs, 1);
+        spi_write_blocking(self->spi, FF, 1);
+    } 
+    else if (sdcard_cmd(self, CMD12, 0, 0xFF, .skip=true)) sdcard_raise(5);
+}
+
+//one CMD25 across segments that continue each other ~ every block is sent from its own caller's memory
+STATIC void sdcard_writev_run(sdcard_SDObject_obj_t *self, sdcard_seg_t *seg, uint32_t nsegs) {
+    int tries = 0;
+    while (nsegs > 1) {
+        uint32_t nblocks;
+        sdcard_seg_run(seg, nsegs, &nblocks);
+        
+        sdcard_stream_release(self);
+        bool bounded = sdcard_set_count(self, nblocks);
+        if (!bounded && nblocks >= PRE_ERASE_MIN) {
+            sdcard_cmd(self, CMD55);
+            sdcard_cmd(self, CMD23, nblocks);
+        }
+        
+        if (sdcard_cmd(self, CMD25, seg->block*self->cdv)) sdcard_raise(5);
+        
+        uint32_t i = 0, s = 0, at = 0;
+        for (; i < nblocks; i++) {
+            const uint8_t *buf = seg[s].buf + (at * BLOCK);
+            if (++at == seg[s].nblocks) { s++; at = 0; }
+            if (sdcard_write(self, TOKEN_CMD25, buf, BLOCK, !(bounded && i == nblocks - 1)) == DATA_CRC_ERROR) break;
+        }
+        
+        if (!bounded || i < nblocks) sdcard_write_token(self, TOKEN_STOP_TRAN);
+        if (i == nblocks) return;
+        
+        //the card dropped a block for its CRC ~ send it again with everything behind it
+        sdcard_crc_again(self, &tries);
+        s      = sdcard_seg_skip(seg, i);
+        seg   += s;
+        nsegs -= s;
+    }
+    
+    sdcard_writeblocks(self, seg->block, seg->buf, seg->nblocks * BLOCK);
+}
+
+//__> CLOCK _____________________________________________________________________________________
+//brings the card back to idle after a read that broke down mid-packet
+STATIC void sdcard_clock_recover(sdcard_SDObject_obj_t *self) {
+    uint8_t sink[BLOCK + 16];
+    sdcard_select(self);
+    spi_read_blocking(self->spi, 0xFF, sink, sizeof(sink));
+    sdcard_cmd(self, CMD12, 0, 0xFF, .skip=true);
+    gpio_put(self->cs, 1);
+    spi_write_blocking(self->spi, FF, 1);
+}
+
+//reads the reference blocks again ~ a timeout, a CRC retry or any changed byte means the clock is too fast
+STATIC bool sdcard_clock_verify(sdcard_SDObject_obj_t *self, const uint8_t *ref, uint8_t *buf, uint32_t mid) {
+    uint32_t errors = self->crc.errors;
+    bool ok = true;
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        for (int pass = 0; ok && pass < AUTO_PASSES; pass++) {
+            sdcard_readblocks(self, 0, buf, BLOCK * 2);
+            sdcard_readblocks(self, mid, buf + (BLOCK * 2), BLOCK);
+            ok = (memcmp(ref, buf, BLOCK * 3) == 0) && (self->crc.errors == errors);
+        }
+        nlr_pop();
+    } else ok = false;
+    
+    return ok;
+}
+
+//climbs the SPI divider ladder from BAUD_DEFAULT to the card's rated clock and keeps the last rate that reads back cleanly
+STATIC uint32_t sdcard_clock_auto(sdcard_SDObject_obj_t *self) {
+    uint32_t peri = clock_get_hz(clk_peri);
+    uint32_t mid  = self->sectors / 2;
+    uint32_t good = sdcard_clock_set(self, BAUD_DEFAULT);
+    
+    //reference copy ~ a multi-block run and a single block, read at the default clock
+    uint8_t *ref = m_new(uint8_t, BLOCK * 6);
+    uint8_t *buf = ref + (BLOCK * 3);
+    sdcard_readblocks(self, 0, ref, BLOCK * 2);
+    sdcard_readblocks(self, mid, ref + (BLOCK * 2), BLOCK);
+    
+    //the SPI block only divides clk_peri by even prescales
+    for (uint32_t div = (peri / good) & ~1; div >= 2; div -= 2) {
+        uint32_t rate = peri / div;
+        if (rate <= good)             continue;
+        if (rate > self->tran_speed)  break;
+        
+        sdcard_clock_set(self, rate);
+        if (!sdcard_clock_verify(self, ref, buf, mid)) {
+            sdcard_clock_set(self, good);
+            sdcard_clock_recover(self);
+            break;
+        }
+        good = self->baudrate;
+    }
+    
+    good = sdcard_clock_set(self, good);
+    bool ok = sdcard_clock_verify(self, ref, buf, mid);
+    m_del(uint8_t, ref, BLOCK * 6);
+    
+    if (!ok) mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Clock Tuning Failed"));
+    return good;
+}
+
+
+//__> QUEUE _____________________________________________________________________________________
+STATIC void sdcard_queue_flush(sdcard_SDObject_obj_t *self, sdcard_queue_t *q) {
+    if (q->alarm) {
+        cancel_alarm(q->alarm);
+        q->alarm = 0;
+    }
+    
+    if (!q->count) return;
+    
+    sdcard_writeblocks(self, q->start, q->data, q->count * BLOCK);
+    q->runs++;
+    q->count = 0;
+}
+
+//the card must hold anything queued in [blocknum, blocknum + nblocks) before that range is read
+STATIC void sdcard_queue_settle(sdcard_SDObject_obj_t *self, uint32_t blocknum, uint32_t nblocks) {
+    sdcard_queue_t *q = &self->queue;
+    if (q->count && blocknum < q->start + q->count && q->start < blocknum + nblocks) 
+        sdcard_queue_flush(self, q);
+}
+
+STATIC int64_t sdcard_queue_alarm(alarm_id_t id, void *user_data);
+
+STATIC mp_obj_t SDObject_flush(mp_obj_t self_in) {
+    sdcard_SDObject_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    sdcard_queue_t *q = &self->queue;
+    
+    //scheduled from the alarm while a wait yields, an awaitable holds the card (or another on the bus) or the worker is busy ~ try again later instead of cutting into the transfer
+    if (self->wait.yielding || self->aio != NULL || sdcard_bus_busy(self) || (self->worker != NULL && self->worker->finished != self->worker->tag)) {
+        if (q->count && !q->alarm) q->alarm = add_alarm_in_ms(q->flush_ms ? q->flush_ms : 1, sdcard_queue_alarm, self, true);
+        return mp_const_none;
+    }
+    
+    sdcard_queue_flush(self, q);
+    return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(SDObject_flush_obj, SDObject_flush);
+
+//runs in IRQ context ~ the flush itself is handed to the VM
+STATIC int64_t sdcard_queue_alarm(alarm_id_t id, void *user_data) {
+    sdcard_SDObject_obj_t *self = user_data;
+    self->queue.alarm = 0;
+    mp_sched_schedule(MP_OBJ_FROM_PTR(&SDObject_flush_obj), MP_OBJ_FROM_PTR(self));
+    return 0;
+}
+
+//extends the pending run when the blocks continue or overwrite it ~ anything else flushes it first
+STATIC void sdcard_queue_write(sdcard_SDObject_obj_t *self, sdcard_queue_t *q, uint32_t blocknum, const uint8_t *buf, uint32_t nblocks) {
+    bool joins = q->count && blocknum >= q->start && blocknum <= q->start + q->count;
+    
+    if (!joins || (blocknum - q->start) + nblocks > q->capacity) {
+        sdcard_queue_flush(self, q);
+        
+        //runs that fill the queue on their own gain nothing from it
+        if (nblocks >= q->capacity) {
+            sdcard_writeblocks(self, blocknum, buf, nblocks * BLOCK);
+            q->queued += nblocks;
+            q->runs++;
+            return;
+        }
+        q->start = blocknum;
+    }
+    
+    uint32_t at = blocknum - q->start;
+    memcpy(q->data + (at * BLOCK), buf, nblocks * BLOCK);
+    if (at + nblocks > q->count) {
+        q->queued += (at + nblocks) - q->count;
+        q->count   = at + nblocks;
+    }
+    
+    if (q->count == q->capacity) sdcard_queue_flush(self, q);
+    else if (q->flush_ms && !q->alarm) q->alarm = add_alarm_in_ms(q->flush_ms, sdcard_queue_alarm, self, true);
+}
+
+STATIC mp_obj_t SDObject_queue_info(mp_obj_t self_in) {
+    sdcard_SDObject_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    sdcard_queue_t *q = &self->queue;
+    
+    mp_obj_t info = mp_obj_new_dict(6);
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_capacity), mp_obj_new_int_from_uint(q->capacity));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_flush_ms), mp_obj_new_int_from_uint(q->flush_ms));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_pending) , mp_obj_new_int_from_uint(q->count));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_blocks)  , mp_obj_new_int_from_uint(q->queued));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_runs)    , mp_obj_new_int_from_uint(q->runs));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_avg_run) , mp_obj_new_float(q->runs ? (float)q->queued / q->runs : 0.0f));
+    return info;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(SDObject_queue_info_obj, SDObject_queue_info);
+
+
+//__> PREFETCH _____________________________________________________________________________________
+//drops what is held ~ blocks nobody asked for count as waste and shrink the next window
+STATIC void sdcard_prefetch_drop(sdcard_prefetch_t *pf) {
+    uint32_t unused = 0;
+    for (uint32_t i = 0; i < pf->count; i++) unused += !pf->served[i];
+    
+    pf->wasted += unused;
+    if (unused > (pf->count >> 1)) pf->window >>= 1;
+    pf->count = 0;
+}
+
+//replaces what is held with a window starting at blocknum
+STATIC void sdcard_prefetch_fill(sdcard_SDObject_obj_t *self, sdcard_prefetch_t *pf, uint32_t blocknum) {
+    uint32_t count = pf->window;
+    if (blocknum + count > self->sectors) count = self->sectors - blocknum;
+    
+    sdcard_prefetch_drop(pf);
+    sdcard_queue_settle(self, blocknum, count);
+    sdcard_readblocks(self, blocknum, pf->data, count * BLOCK);
+    
+    pf->start = blocknum;
+    pf->count = count;
+    memset(pf->served, 0, count);
+}
+
+STATIC void sdcard_prefetch_read(sdcard_SDObject_obj_t *self, sdcard_prefetch_t *pf, uint32_t blocknum, uint8_t *buf, uint32_t nblocks) {
+    //sequential requests double the window up to the budget ~ anything else turns read-ahead off until the pattern returns
+    if (blocknum == pf->next) {
+        pf->window = (pf->window) ? (pf->window << 1) : (nblocks << 1);
+        if (pf->window > pf->capacity) pf->window = pf->capacity;
+    } else pf->window = 0;
+    pf->next = blocknum + nblocks;
+    
+    while (nblocks) {
+        if (blocknum >= pf->start && blocknum < pf->start + pf->count) {
+            uint32_t at = blocknum - pf->start;
+            uint32_t n  = pf->count - at;
+            if (n > nblocks) n = nblocks;
+            
+            memcpy(buf, pf->data + (at * BLOCK), n * BLOCK);
+            memset(pf->served + at, 1, n);
+            pf->hits += n;
+            
+            blocknum += n;
+            buf      += n * BLOCK;
+            nblocks  -= n;
+            continue;
+        }
+        
+        //the caller waits for the first blocks of a fresh window ~ only the rest is read-ahead
+        if (pf->window > nblocks) {
+            sdcard_prefetch_fill(self, pf, blocknum);
+            uint32_t n = (nblocks < pf->count) ? nblocks : pf->count;
+            
+            memcpy(buf, pf->data, n * BLOCK);
+            memset(pf->served, 1, n);
+            pf->misses     += n;
+            pf->prefetched += pf->count - n;
+            
+            blocknum += n;
+            buf      += n * BLOCK;
+            nblocks  -= n;
+            continue;
+        }
+        
+        //nothing worth reading ahead ~ straight into the caller's memory
+        sdcard_readblocks(self, blocknum, buf, nblocks * BLOCK);
+        pf->misses += nblocks;
+        return;
+    }
+}
+
+//keeps held copies in step with what goes to the card
+STATIC void sdcard_prefetch_write(sdcard_prefetch_t *pf, uint32_t blocknum, const uint8_t *buf, uint32_t nblocks) {
+    for (uint32_t i = 0; i < nblocks; i++) {
+        uint32_t b = blocknum + i;
+        if (b >= pf->start && b < pf->start + pf->count)
+            memcpy(pf->data + ((b - pf->start) * BLOCK), buf + (i * BLOCK), BLOCK);
+    }
+}
+
+STATIC mp_obj_t SDObject_prefetch_info(mp_obj_t self_in) {
+    sdcard_SDObject_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    sdcard_prefetch_t *pf = &self->prefetch;
+    uint32_t total = pf->hits + pf->misses;
+    
+    mp_obj_t info = mp_obj_new_dict(8);
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_budget)    , mp_obj_new_int_from_uint(pf->capacity * BLOCK));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_window)    , mp_obj_new_int_from_uint(pf->window));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_hits)      , mp_obj_new_int_from_uint(pf->hits));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_misses)    , mp_obj_new_int_from_uint(pf->misses));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_hit_rate)  , mp_obj_new_float(total ? (float)pf->hits / total : 0.0f));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_prefetched), mp_obj_new_int_from_uint(pf->prefetched));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_wasted)    , mp_obj_new_int_from_uint(pf->wasted * BLOCK));    //bytes
+    return info;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(SDObject_prefetch_info_obj, SDObject_prefetch_info);
+
+//what the cache sits on ~ the card, seen through read-ahead when it is enabled
+STATIC void sdcard_backing_read(sdcard_SDObject_obj_t *self, uint32_t blocknum, uint8_t *buf, int nblocks) {
+    sdcard_queue_settle(self, blocknum, nblocks);
+    if (self->prefetch.capacity) sdcard_prefetch_read(self, &self->prefetch, blocknum, buf, nblocks);
+    else                         sdcard_readblocks(self, blocknum, buf, nblocks * BLOCK);
+}
+
+STATIC void sdcard_backing_write(sdcard_SDObject_obj_t *self, uint32_t blocknum, const uint8_t *buf, int nblocks) {
+    if (self->queue.capacity) sdcard_queue_write(self, &self->queue, blocknum, buf, nblocks);
+    else                      sdcard_writeblocks(self, blocknum, buf, nblocks * BLOCK);
+    if (self->prefetch.count) sdcard_prefetch_write(&self->prefetch, blocknum, buf, nblocks);
+}
+
+
+//__> CACHE _____________________________________________________________________________________
+STATIC int sdcard_cache_find(sdcard_cache_t *c, uint32_t block) {
+    int base = (block % c->sets) * c->ways;
+    for (int i = base; i < base + c->ways; i++)
+        if (c->used[i] && c->tags[i] == block) return i;
+    return -1;
+}
+
+STATIC void sdcard_cache_touch(sdcard_cache_t *c, int line) {
+    c->used[line] = ++c->clock;
+}
+
+//picks a line in the block's set ~ a free one if possible, otherwise the least recently used (written back first)
+STATIC int sdcard_cache_claim(sdcard_SDObject_obj_t *self, sdcard_cache_t *c, uint32_t block) {
+    int base   = (block % c->sets) * c->ways;
+    int victim = base;
+    for (int i = base; i < base + c->ways; i++) {
+        if (!c->used[i]) { victim = i; break; }
+        if (c->used[i] < c->used[victim]) victim = i;
+    }
+    
+    if (c->used[victim]) {
+        c->evictions++;
+        if (c->dirty[victim]) {
+            sdcard_backing_write(self, c->tags[victim], c->data + (victim * BLOCK), 1);
+            c->dirty[victim] = 0;
+            c->writebacks++;
+        }
+    }
+    
+    c->tags[victim] = block;
+    sdcard_cache_touch(c, victim);
+    return victim;
+}
+
+//writes every dirty line back in block order so neighbouring sectors leave together
+STATIC void sdcard_cache_flush(sdcard_SDObject_obj_t *self, sdcard_cache_t *c) {
+    for (;;) {
+        int next = -1;
+        for (int i = 0; i < c->lines; i++)
+            if (c->dirty[i] && (next < 0 || c->tags[i] < c->tags[next])) next = i;
+        if (next < 0) return;
+        
+        sdcard_backing_write(self, c->tags[next], c->data + (next * BLOCK), 1);
+        c->dirty[next] = 0;
+        c->writebacks++;
+    }
+}
+
+//hits are copied out, misses are read from the card in contiguous runs ~ only single-block misses are kept
+STATIC void sdcard_cache_read(sdcard_SDObject_obj_t *self, sdcard_cache_t *c, uint32_t blocknum, uint8_t *buf, int nblocks) {
+    if (nblocks == 1) {
+        int line = sdcard_cache_find(c, blocknum);
+        if (line < 0) {
+            c->misses++;
+            line = sdcard_cache_claim(self, c, blocknum);
+            //a failed read must not leave a line claiming to hold this block
+            c->used[line] = 0;
+            sdcard_backing_read(self, blocknum, c->data + (line * BLOCK), 1);
+        } else c->hits++;
+        
+        sdcard_cache_touch(c, line);
+        memcpy(buf, c->data + (line * BLOCK), BLOCK);
+        return;
+    }
+    
+    int run = -1;
+    for (int i = 0; i <= nblocks; i++) {
+        int line = (i < nblocks) ? sdcard_cache_find(c, blocknum + i) : -1;
+        
+        if (line < 0 && i < nblocks) {
+            c->misses++;
+            if (run < 0) run = i;
+            continue;
+        }
+        
+        if (run > -1) {
+            sdcard_backing_read(self, blocknum + run, buf + (run * BLOCK), i - run);
+            
+            for (int j = run; c->keep && j < i; j++) {
+                int fresh = sdcard_cache_claim(self, c, blocknum + j);
+                memcpy(c->data + (fresh * BLOCK), buf + (j * BLOCK), BLOCK);
+            }
+            run = -1;
+        }
+        
+        if (line > -1) {
+            c->hits++;
+            sdcard_cache_touch(c, line);
+            memcpy(buf + (i * BLOCK), c->data + (line * BLOCK), BLOCK);
+        }
+    }
+}
+
+//single blocks are absorbed ~ larger writes go straight through and refresh any copies they overlap
+STATIC void sdcard_cache_write(sdcard_SDObject_obj_t *self, sdcard_cache_t *c, uint32_t blocknum, const uint8_t *buf, int nblocks) {
+    if (nblocks == 1) {
+        int line = sdcard_cache_find(c, blocknum);
+        if (line < 0) {
+            c->misses++;
+            line = sdcard_cache_claim(self, c, blocknum);
+        } else {
+            c->hits++;
+            sdcard_cache_touch(c, line);
+        }
+        
+        memcpy(c->data + (line * BLOCK), buf, BLOCK);
+        c->dirty[line] = 1;
+        return;
+    }
+    
+    sdcard_backing_write(self, blocknum, buf, nblocks);
+    
+    for (int i = 0; i < nblocks; i++) {
+        int line = sdcard_cache_find(c, blocknum + i);
+        if (line > -1) {
+            memcpy(c->data + (line * BLOCK), buf + (i * BLOCK), BLOCK);
+            c->dirty[line] = 0;
+        }
+    }
+}
+
+STATIC mp_obj_t SDObject_cache_info(mp_obj_t self_in) {
+    sdcard_SDObject_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    sdcard_cache_t *c = &self->cache;
+    
+    int dirty = 0;
+    for (int i = 0; i < c->lines; i++) dirty += c->dirty[i];
+    
+    mp_obj_t info = mp_obj_new_dict(7);
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_lines)     , mp_obj_new_int(c->lines));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_ways)      , mp_obj_new_int(c->ways));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_dirty)     , mp_obj_new_int(dirty));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_hits)      , mp_obj_new_int_from_uint(c->hits));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_misses)    , mp_obj_new_int_from_uint(c->misses));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_evictions) , mp_obj_new_int_from_uint(c->evictions));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_writebacks), mp_obj_new_int_from_uint(c->writebacks));
+    return info;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(SDObject_cache_info_obj, SDObject_cache_info);
+
+//time per checksum shows what integrity costs at a given clock
+STATIC mp_obj_t SDObject_crc_info(mp_obj_t self_in) {
+    sdcard_SDObject_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    sdcard_crc_t *c = &self->crc;
+    
+    mp_obj_t info = mp_obj_new_dict(7);
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_enabled)     , mp_obj_new_bool(c->enabled));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_engine)      , MP_OBJ_NEW_QSTR((self->dma_rx > -1)? MP_QSTR_sniffer : MP_QSTR_table));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_blocks)      , mp_obj_new_int_from_uint(c->blocks));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_errors)      , mp_obj_new_int_from_uint(c->errors));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_retries)     , mp_obj_new_int_from_uint(c->retries));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_us)          , mp_obj_new_int_from_ull(c->us));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_us_per_block), mp_obj_new_float(c->blocks ? (float)c->us / c->blocks : 0.0f));
+    return info;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(SDObject_crc_info_obj, SDObject_crc_info);
+
+//the trace ring oldest first, as bytes ~ `clear` empties it once copied. the worker is let run dry so the copy is whole
+STATIC mp_obj_t SDObject_trace(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum {ARG_clear};
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_clear     , MP_ARG_BOOL, {.u_bool = false}},
+    };
+    
+    sdcard_SDObject_obj_t *self = MP_OBJ_TO_PTR(pos_args[0]);
+    mp_arg_val_t kw[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, kw);
+    
+    sdcard_trace_t *t = &self->trace;
+    if (!t->capacity) return mp_const_none;
+    sdcard_check_idle(self);
+    
+    uint32_t n     = (t->count < t->capacity) ? t->count : t->capacity;
+    uint32_t first = t->count - n;
+    
+    vstr_t vstr;
+    vstr_init_len(&vstr, n * sizeof(sdcard_trace_entry_t));
+    for (uint32_t i = 0; i < n; i++)
+        memcpy(vstr.buf + (i * sizeof(sdcard_trace_entry_t)), &t->entries[(first + i) % t->capacity], sizeof(sdcard_trace_entry_t));
+    
+    if (kw[ARG_clear].u_bool) t->count = 0;
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(SDObject_trace_obj, 1, SDObject_trace);
+
+
+//__> PIN _____________________________________________________________________________________
+STATIC uint16_t sdcard_le16(const uint8_t *b) { return b[0] | (b[1] << 8); }
+STATIC uint32_t sdcard_le32(const uint8_t *b) { return b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32_t)b[3] << 24); }
+
+//length of the run from blocknum (up to nblocks) that is uniformly pinned or not ~ `pin` says which
+STATIC uint32_t sdcard_pin_span(sdcard_SDObject_obj_t *self, uint32_t blocknum, uint32_t nblocks, bool *pin) {
+    uint32_t span = nblocks;
+    *pin = false;
+    
+    for (int r = 0; r < 2; r++) {
+        uint32_t start = self->pin_start[r], end = start + self->pin_count[r];
+        if (!self->pin_count[r]) continue;
+        
+        if (blocknum >= start && blocknum < end) {
+            *pin = true;
+            return (end - blocknum < nblocks) ? end - blocknum : nblocks;
+        }
+        if (start > blocknum && start - blocknum < span) span = start - blocknum;
+    }
+    
+    return span;
+}
+
+//finds the first FAT and the root directory from the boot sector and keeps them in the pinned cache
+STATIC void sdcard_pin_fat(sdcard_SDObject_obj_t *self) {
+    sdcard_cache_t *c = &self->pinned;
+    if (!c->lines) return;
+    
+    //blocks may change sides with a new layout ~ start both caches clean and empty
+    sdcard_io_sync(self);
+    memset(c->used, 0, c->lines * sizeof(uint32_t));
+    if (self->cache.lines) memset(self->cache.used, 0, self->cache.lines * sizeof(uint32_t));
+    self->pin_count[0] = self->pin_count[1] = 0;
+    
+    uint8_t *bs = m_new(uint8_t, BLOCK);
+    uint32_t lba = 0;
+    sdcard_backing_read(self, 0, bs, 1);
+    
+    //no jump instruction or a foreign sector size ~ treat sector 0 as an MBR and follow the first partition
+    if (!((bs[0] == 0xEB || bs[0] == 0xE9) && sdcard_le16(bs + 11) == BLOCK)) {
+        lba = sdcard_le32(bs + 0x1C6);
+        if (lba) sdcard_backing_read(self, lba, bs, 1);
+    }
+    
+    if (bs[510] != 0x55 || bs[511] != 0xAA || sdcard_le16(bs + 11) != BLOCK || !bs[13] || !bs[16]) {
+        m_del(uint8_t, bs, BLOCK);
+        return;
+    }
+    
+    uint32_t spc       = bs[13];
+    uint32_t reserved  = sdcard_le16(bs + 14);
+    uint32_t fats      = bs[16];
+    uint32_t root_ents = sdcard_le16(bs + 17);
+    uint32_t fat_size  = sdcard_le16(bs + 22) ? sdcard_le16(bs + 22) : sdcard_le32(bs + 36);
+    uint32_t root_clus = sdcard_le32(bs + 44);
+    m_del(uint8_t, bs, BLOCK);
+    
+    //only the first FAT copy is read back ~ the mirror would just compete for lines
+    self->pin_start[0] = lba + reserved;
+    self->pin_count[0] = fat_size;
+    
+    //FAT12/16 have a fixed root directory after the FATs, FAT32 keeps it in a cluster
+    uint32_t root = lba + reserved + (fats * fat_size);
+    if (root_ents) {
+        self->pin_start[1] = root;
+        self->pin_count[1] = ((root_ents * 32) + BLOCK - 1) / BLOCK;
+    } else {
+        self->pin_start[1] = root + ((root_clus - 2) * spc);
+        self->pin_count[1] = spc;
+    }
+    
+    //warm up with the root directory and as much of the FAT as fits
+    uint8_t *tmp    = m_new(uint8_t, BLOCK << 3);
+    uint32_t budget = c->lines;
+    for (int r = 1; r >= 0; r--) {
+        uint32_t left = (self->pin_count[r] < budget) ? self->pin_count[r] : budget;
+        budget -= left;
+        
+        for (uint32_t b = self->pin_start[r]; left; ) {
+            uint32_t n = (left < 8) ? left : 8;
+            sdcard_cache_read(self, c, b, tmp, n);
+            b    += n;
+            left -= n;
+        }
+    }
+    m_del(uint8_t, tmp, BLOCK << 3);
+}
+
+STATIC mp_obj_t SDObject_pin_info(mp_obj_t self_in) {
+    sdcard_SDObject_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    sdcard_cache_t *c = &self->pinned;
+    
+    mp_obj_t fat[2]  = {mp_obj_new_int_from_uint(self->pin_start[0]), mp_obj_new_int_from_uint(self->pin_count[0])};
+    mp_obj_t root[2] = {mp_obj_new_int_from_uint(self->pin_start[1]), mp_obj_new_int_from_uint(self->pin_count[1])};
+    
+    mp_obj_t info = mp_obj_new_dict(6);
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_lines)    , mp_obj_new_int(c->lines));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_fat)      , mp_obj_new_tuple(2, fat));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_root)     , mp_obj_new_tuple(2, root));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_hits)     , mp_obj_new_int_from_uint(c->hits));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_misses)   , mp_obj_new_int_from_uint(c->misses));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_evictions), mp_obj_new_int_from_uint(c->evictions));
+    return info;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(SDObject_pin_info_obj, SDObject_pin_info);
+
+//every card sharing this one's SPI block as (cs, baudrate), the cs the bus is set up for and how often it changed hands
+STATIC mp_obj_t SDObject_bus_info(mp_obj_t self_in) {
+    sdcard_SDObject_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    sdcard_bus_t *bus = self->bus;
+    
+    mp_obj_t cards = mp_obj_new_list(0, NULL);
+    for (uint8_t i = 0; i < bus->devices; i++) {
+        mp_obj_t card[2] = {MP_OBJ_NEW_SMALL_INT(bus->dev[i]->cs), mp_obj_new_int_from_uint(bus->dev[i]->baudrate)};
+        mp_obj_list_append(cards, mp_obj_new_tuple(2, card));
+    }
+    
+    mp_obj_t info = mp_obj_new_dict(3);
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_cards)    , cards);
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_active)   , bus->active ? MP_OBJ_NEW_SMALL_INT(bus->active->cs) : mp_const_none);
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_switches) , mp_obj_new_int_from_uint(bus->switches));
+    return info;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(SDObject_bus_info_obj, SDObject_bus_info);
+
+
+//__> BLOCK DEVICE _____________________________________________________________________________________
+//the layers between the VFS and the card
+STATIC void sdcard_cached_read(sdcard_SDObject_obj_t *self, uint32_t blocknum, uint8_t *buf, uint32_t nblocks) {
+    if (self->cache.lines) sdcard_cache_read(self, &self->cache, blocknum, buf, nblocks);
+    else                   sdcard_backing_read(self, blocknum, buf, nblocks);
+}
+
+STATIC void sdcard_cached_write(sdcard_SDObject_obj_t *self, uint32_t blocknum, const uint8_t *buf, uint32_t nblocks) {
+    if (self->cache.lines) sdcard_cache_write(self, &self->cache, blocknum, buf, nblocks);
+    else                   sdcard_backing_write(self, blocknum, buf, nblocks);
+}
+
+STATIC void sdcard_erase_settle(sdcard_SDObject_obj_t *self, uint32_t blocknum, uint32_t nblocks, bool write);
+STATIC void sdcard_erase_flush(sdcard_SDObject_obj_t *self);
+
+//pinned metadata and everything else are split apart so they never share lines
+STATIC void sdcard_layered_read(sdcard_SDObject_obj_t *self, uint32_t blocknum, uint8_t *buf, uint32_t nblocks) {
+    bool pin;
+    for (uint32_t n; nblocks; nblocks -= n) {
+        n = sdcard_pin_span(self, blocknum, nblocks, &pin);
+        if (pin) sdcard_cache_read(self, &self->pinned, blocknum, buf, n);
+        else     sdcard_cached_read(self, blocknum, buf, n);
+        blocknum += n;
+        buf      += n * BLOCK;
+    }
+}
+
+STATIC void sdcard_layered_write(sdcard_SDObject_obj_t *self, uint32_t blocknum, const uint8_t *buf, uint32_t nblocks) {
+    bool pin;
+    for (uint32_t n; nblocks; nblocks -= n) {
+        n = sdcard_pin_span(self, blocknum, nblocks, &pin);
+        if (pin) sdcard_cache_write(self, &self->pinned, blocknum, buf, n);
+        else     sdcard_cached_write(self, blocknum, buf, n);
+        blocknum += n;
+        buf      += n * BLOCK;
+    }
+}
+
+STATIC void sdcard_io_read(sdcard_SDObject_obj_t *self, uint32_t blocknum, uint8_t *buf, int len) {
+    if ((!(len/BLOCK)) || (len%BLOCK)) mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid Buffer Length"));
+    
+    uint64_t start = time_us_64();
+    sdcard_erase_settle(self, blocknum, len/BLOCK, false);
+    sdcard_layered_read(self, blocknum, buf, len/BLOCK);
+    sdcard_stats_op(self, STAT_READ, len, start);
+}
+
+STATIC void sdcard_io_write(sdcard_SDObject_obj_t *self, uint32_t blocknum, const uint8_t *buf, int len) {
+    if ((!(len/BLOCK)) || (len%BLOCK)) mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid Buffer Length"));
+    
+    uint64_t start = time_us_64();
+    sdcard_erase_settle(self, blocknum, len/BLOCK, true);
+    sdcard_layered_write(self, blocknum, buf, len/BLOCK);
+    sdcard_stats_op(self, STAT_WRITE, len, start);
+}
+
+//caches and read-ahead keep copies a run past them would leave stale ~ with any of them on, segments go through them one by one
+STATIC bool sdcard_io_direct(sdcard_SDObject_obj_t *self) {
+    return !self->cache.lines && !self->pinned.lines && !self->prefetch.capacity;
+}
+
+//sorted segments ~ each run of continuing blocks is one transaction. queued blocks the run covers reach the card first
+STATIC void sdcard_io_readv(sdcard_SDObject_obj_t *self, sdcard_seg_t *seg, uint32_t nsegs) {
+    uint64_t start = time_us_64();
+    uint32_t len   = 0;
+    for (uint32_t i = 0, n, nblocks; i < nsegs; i += n) {
+        n    = sdcard_seg_run(seg + i, nsegs - i, &nblocks);
+        len += nblocks * BLOCK;
+        sdcard_erase_settle(self, seg[i].block, nblocks, false);
+        if (sdcard_io_direct(self)) {
+            sdcard_queue_settle(self, seg[i].block, nblocks);
+            sdcard_readv_run(self, seg + i, n);
+        }
+        else for (uint32_t j = i; j < i + n; j++) sdcard_layered_read(self, seg[j].block, seg[j].buf, seg[j].nblocks);
+    }
+    sdcard_stats_op(self, STAT_READ, len, start);
+}
+
+//a queued copy of a block the run overwrites would land on top of it later ~ the queue is written out first
+STATIC void sdcard_io_writev(sdcard_SDObject_obj_t *self, sdcard_seg_t *seg, uint32_t nsegs) {
+    uint64_t start = time_us_64();
+    uint32_t len   = 0;
+    for (uint32_t i = 0, n, nblocks; i < nsegs; i += n) {
+        n    = sdcard_seg_run(seg + i, nsegs - i, &nblocks);
+        len += nblocks * BLOCK;
+        sdcard_erase_settle(self, seg[i].block, nblocks, true);
+        if (sdcard_io_direct(self)) {
+            sdcard_queue_settle(self, seg[i].block, nblocks);
+            sdcard_writev_run(self, seg + i, n);
+        }
+        else for (uint32_t j = i; j < i + n; j++) sdcard_layered_write(self, seg[j].block, seg[j].buf, seg[j].nblocks);
+    }
+    sdcard_stats_op(self, STAT_WRITE, len, start);
+}
+
+STATIC void sdcard_io_flush(sdcard_SDObject_obj_t *self) {
+    uint64_t start = time_us_64();
+    sdcard_stream_release(self);
+    sdcard_erase_flush(self);
+    if (self->pinned.lines) sdcard_cache_flush(self, &self->pinned);
+    if (self->cache.lines)  sdcard_cache_flush(self, &self->cache);
+    sdcard_queue_flush(self, &self->queue);
+    
+    //sync means on the card ~ a deferred write is waited out here
+    sdcard_busy_settle(self);
+    sdcard_stats_op(self, STAT_SYNC, 0, start);
+}
+
+
+//__> WORKER _____________________________________________________________________________________
+//core1 carries out requests from a ring and answers on a second one ~ each ring has one producer and one consumer, so neither needs a lock
+STATIC sdcard_work_t *sdcard_ring_slot(sdcard_ring_t *r) {
+    return &r->slots[r->tail % WORK_SLOTS];
+}
+
+//publishes the slot filled at tail
+STATIC void sdcard_ring_push(sdcard_ring_t *r) {
+    __dmb();
+    r->tail++;
+    __sev();
+}
+
+//the oldest entry ~ NULL when the ring is empty
+STATIC sdcard_work_t *sdcard_ring_peek(sdcard_ring_t *r) {
+    if (r->head == r->tail) return NULL;
+    __dmb();
+    return &r->slots[r->head % WORK_SLOTS];
+}
+
+//hands the oldest slot back to the producer
+STATIC void sdcard_ring_pop(sdcard_ring_t *r) {
+    __dmb();
+    r->head++;
+    __sev();
+}
+
+STATIC void sdcard_worker_main(void) {
+#if PICO_SDK_VERSION_MAJOR > 1 || PICO_SDK_VERSION_MINOR >= 2
+    //the worker runs from flash ~ core0 has to be able to park it while flash is written
+    multicore_lockout_victim_init();
+#endif
+    sdcard_SDObject_obj_t *self = sdcard_worker_owner;
+    sdcard_worker_t *w = self->worker;
+    
+    while (w->running) {
+        sdcard_work_t *job = sdcard_ring_peek(&w->req);
+        if (job == NULL) {
+            __wfe();
+            continue;
+        }
+        
+        sdcard_indicate(self, true);
+        int err = setjmp(sdcard_fault);
+        if (err == 0) {
+            switch (job->op) {
+                case WORK_READ  : sdcard_io_read(self, job->blocknum, job->buf, job->len);     break;
+                case WORK_WRITE : sdcard_io_write(self, job->blocknum, job->buf, job->len);    break;
+                case WORK_READV : sdcard_io_readv(self, (sdcard_seg_t *)job->buf, job->len);  break;
+                case WORK_WRITEV: sdcard_io_writev(self, (sdcard_seg_t *)job->buf, job->len); break;
+                default         : sdcard_io_flush(self);                                      break;
+            }
+        }
+        sdcard_indicate(self, false);
+        
+        if (job->sync) w->sync_err = err;
+        else {
+            sdcard_work_t *done = sdcard_ring_slot(&w->done);
+            done->tag = job->tag;
+            done->op  = job->op;
+            done->err = err;
+            sdcard_ring_push(&w->done);
+        }
+        
+        __dmb();
+        w->finished = job->tag;
+        sdcard_ring_pop(&w->req);
+    }
+    
+    w->stopped = true;
+    __sev();
+}
+
+//core0 waits until request `tag` is carried out ~ scheduled callbacks run meanwhile, and card calls they make raise EBUSY
+STATIC void sdcard_worker_until(sdcard_SDObject_obj_t *self, uint32_t tag) {
+    sdcard_worker_t *w = self->worker;
+    
+    nlr_buf_t nlr;
+    self->wait.yielding = true;
+    if (nlr_push(&nlr) == 0) {
+        while ((int32_t)(w->finished - tag) < 0) MICROPY_EVENT_POLL_HOOK
+        nlr_pop();
+        self->wait.yielding = false;
+    } else {
+        //the request carries on without its caller ~ its slot still holds the buffer
+        self->wait.yielding = false;
+        nlr_jump(nlr.ret_val);
+    }
+}
+
+STATIC void sdcard_worker_drain(sdcard_SDObject_obj_t *self) {
+    sdcard_worker_t *w = self->worker;
+    if (w->finished != w->tag) sdcard_worker_until(self, w->tag);
+}
+
+//raises when a request can't be posted now
+STATIC void sdcard_worker_check(sdcard_SDObject_obj_t *self, bool sync) {
+    sdcard_worker_t *w = self->worker;
+    if (w == NULL) mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Worker Not Running"));
+    if (self->wait.yielding || self->aio != NULL) mp_raise_OSError(16); // EBUSY
+    
+    //every unpolled completion has to fit the completion ring ~ one slot stays free for a blocking call
+    if (!sync && w->unpolled >= WORK_SLOTS - 1) mp_raise_OSError(11); // EAGAIN
+}
+
+//hands a checked request to core1 and returns its tag ~ `obj` must keep everything `buf` reaches alive
+STATIC uint32_t sdcard_worker_queue(sdcard_SDObject_obj_t *self, uint8_t op, uint32_t blocknum, uint8_t *buf, uint32_t len, mp_obj_t obj, bool sync) {
+    sdcard_worker_t *w = self->worker;
+    
+    //blocking calls abandoned by an exception can still be in flight ~ wait for the oldest to make room
+    if (w->req.tail - w->req.head >= WORK_SLOTS) sdcard_worker_until(self, w->tag - WORK_SLOTS + 1);
+    
+    //a stream only opens while the worker is idle ~ closing it here can't cut into a request
+    sdcard_stream_release(self);
+    
+    sdcard_work_t *job = sdcard_ring_slot(&w->req);
+    job->tag      = ++w->tag;
+    job->op       = op;
+    job->sync     = sync;
+    job->err      = 0;
+    job->blocknum = blocknum;
+    job->buf      = buf;
+    job->len      = len;
+    job->obj      = obj;
+    sdcard_ring_push(&w->req);
+    
+    if (!sync) w->unpolled++;
+    return job->tag;
+}
+
+//queues one request and returns its tag ~ buffers are checked here because core1 can't raise into Python
+STATIC uint32_t sdcard_worker_post(sdcard_SDObject_obj_t *self, uint8_t op, mp_obj_t block_num, mp_obj_t buf, bool sync) {
+    sdcard_worker_check(self, sync);
+    
+    mp_buffer_info_t bufinfo = {0};
+    if (op != WORK_SYNC) {
+        mp_get_buffer_raise(buf, &bufinfo, (op == WORK_READ) ? MP_BUFFER_WRITE : MP_BUFFER_READ);
+        if ((!(bufinfo.len/BLOCK)) || (bufinfo.len%BLOCK)) mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid Buffer Length"));
+    }
+    
+    return sdcard_worker_queue(self, op, (op == WORK_SYNC) ? 0 : mp_obj_get_int(block_num), bufinfo.buf, bufinfo.len, buf, sync);
+}
+
+//the blocking form ~ same semantics as running the request on this core
+STATIC void sdcard_worker_call(sdcard_SDObject_obj_t *self, uint8_t op, mp_obj_t block_num, mp_obj_t buf) {
+    sdcard_worker_until(self, sdcard_worker_post(self, op, block_num, buf, true));
+    if (self->worker->sync_err) sdcard_raise(self->worker->sync_err);
+}
+
+STATIC void sdcard_worker_start(sdcard_SDObject_obj_t *self) {
+#if !SDCARD_HAL_PARK
+    //nothing would park core1 while core0 writes flash ~ a write to the internal filesystem would stall or fault it mid-transaction
+    mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Worker Unsupported"));
+#endif
+    if (sdcard_worker_owner != NULL) mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Core1 In Use"));
+    if (self->bus->devices > 1)      mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Shared Bus"));
+    
+    sdcard_worker_t *w = m_new0(sdcard_worker_t, 1);
+    w->running = true;
+    self->worker        = w;
+    sdcard_worker_owner = self;
+    
+    multicore_reset_core1();
+    multicore_launch_core1(sdcard_worker_main);
+}
+
+//stops at the next request boundary ~ anything still queued is dropped
+STATIC void sdcard_worker_stop(sdcard_SDObject_obj_t *self) {
+    sdcard_worker_t *w = self->worker;
+    if (w == NULL) return;
+    
+    w->running = false;
+    __sev();
+    while (!w->stopped) tight_loop_contents();
+    
+    multicore_reset_core1();
+    self->worker        = NULL;
+    sdcard_worker_owner = NULL;
+}
+
+STATIC mp_obj_t SDObject_submit_read(mp_obj_t self_in, mp_obj_t block_num, mp_obj_t buf) {
+    sdcard_SDObject_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return mp_obj_new_int_from_uint(sdcard_worker_post(self, WORK_READ, block_num, buf, false));
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(SDObject_submit_read_obj, SDObject_submit_read);
+
+STATIC mp_obj_t SDObject_submit_write(mp_obj_t self_in, mp_obj_t block_num, mp_obj_t buf) {
+    sdcard_SDObject_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return mp_obj_new_int_from_uint(sdcard_worker_post(self, WORK_WRITE, block_num, buf, false));
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(SDObject_submit_write_obj, SDObject_submit_write);
+
+STATIC mp_obj_t SDObject_submit_sync(mp_obj_t self_in) {
+    sdcard_SDObject_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return mp_obj_new_int_from_uint(sdcard_worker_post(self, WORK_SYNC, mp_const_none, mp_const_none, false));
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(SDObject_submit_sync_obj, SDObject_submit_sync);
+
+//the oldest completion as (tag, errno) ~ None when nothing has finished
+STATIC mp_obj_t SDObject_poll(mp_obj_t self_in) {
+    sdcard_SDObject_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    sdcard_worker_t *w = self->worker;
+    if (w == NULL) mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Worker Not Running"));
+    
+    sdcard_work_t *done = sdcard_ring_peek(&w->done);
+    if (done == NULL) return mp_const_none;
+    
+    mp_obj_t out[2] = {mp_obj_new_int_from_uint(done->tag), MP_OBJ_NEW_SMALL_INT((done->err == ERR_RESPONSE) ? 110 : done->err)};
+    sdcard_ring_pop(&w->done);
+    w->unpolled--;
+    return mp_obj_new_tuple(2, out);
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(SDObject_poll_obj, SDObject_poll);
+
+STATIC void sdcard_io_sync(sdcard_SDObject_obj_t *self) {
+    if (self->worker != NULL) {
+        sdcard_worker_call(self, WORK_SYNC, mp_const_none, mp_const_none);
+        return;
+    }
+    
+    sdcard_check_idle(self);
+    sdcard_io_flush(self);
+}
+
+STATIC mp_obj_t SDObject_readblocks(mp_obj_t self_in, mp_obj_t block_num, mp_obj_t buf) {
+    sdcard_SDObject_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->worker != NULL) {
+        sdcard_worker_call(self, WORK_READ, block_num, buf);
+        return mp_const_true;
+    }
+    
+    mp_buffer_info_t bufinfo;
+    sdcard_check_idle(self);
+    sdcard_indicate(self, true);
+    
+    mp_get_buffer_raise(buf, &bufinfo, MP_BUFFER_WRITE);
+    sdcard_io_read(self, mp_obj_get_int(block_num), bufinfo.buf, bufinfo.len);
+    
+    sdcard_indicate(self, false);
+    //errors are handled manually in sdcard_io_read ~ if we got this far there was no error
+    return mp_const_true;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(SDObject_readblocks_obj, SDObject_readblocks);
+
+STATIC mp_obj_t SDObject_writeblocks(mp_obj_t self_in, mp_obj_t block_num, mp_obj_t buf) {
+    sdcard_SDObject_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->worker != NULL) {
+        sdcard_worker_call(self, WORK_WRITE, block_num, buf);
+        return mp_const_true;
+    }
+    
+    mp_buffer_info_t bufinfo;
+    sdcard_check_idle(self);
+    sdcard_indicate(self, true);
+
+    mp_get_buffer_raise(buf, &bufinfo, MP_BUFFER_READ);
+    sdcard_io_write(self, mp_obj_get_int(block_num), bufinfo.buf, bufinfo.len);
+    
+    sdcard_indicate(self, false);
+    //errors are handled manually in sdcard_io_write ~ if we got this far there was no error
+    return mp_const_true;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(SDObject_writeblocks_obj, SDObject_writeblocks);
+
+//(block, buf) pairs from a list or tuple, sorted by block ~ NULL when there are none
+STATIC sdcard_seg_t *sdcard_seg_parse(mp_obj_t reqs, size_t *nsegs, mp_uint_t flags) {
+    mp_obj_t *items;
+    mp_obj_get_array(reqs, nsegs, &items);
+    if (!*nsegs) return NULL;
+    
+    sdcard_seg_t *seg = m_new(sdcard_seg_t, *nsegs);
+    for (size_t i = 0; i < *nsegs; i++) {
+        mp_obj_t *pair;
+        mp_buffer_info_t bufinfo;
+        mp_obj_get_array_fixed_n(items[i], 2, &pair);
+        mp_get_buffer_raise(pair[1], &bufinfo, flags);
+        if ((!(bufinfo.len/BLOCK)) || (bufinfo.len%BLOCK)) mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid Buffer Length"));
+        
+        mp_int_t block = mp_obj_get_int(pair[0]);
+        if (block < 0) mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid Block Range"));
+        
+        //callers mostly pass them nearly in order ~ insertion sort does next to nothing then
+        sdcard_seg_t cur = {block, bufinfo.buf, bufinfo.len/BLOCK};
+        size_t j = i;
+        for (; j && seg[j - 1].block > cur.block; j--) seg[j] = seg[j - 1];
+        seg[j] = cur;
+    }
+    return seg;
+}
+
+//readv and writev ~ on the worker the request keeps the pairs and the segments alive, as a blocking call can be abandoned
+STATIC mp_obj_t sdcard_vector(mp_obj_t self_in, mp_obj_t reqs, uint8_t op) {
+    sdcard_SDObject_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    
+    size_t nsegs;
+    sdcard_seg_t *seg = sdcard_seg_parse(reqs, &nsegs, (op == WORK_READV) ? MP_BUFFER_WRITE : MP_BUFFER_READ);
+    if (!nsegs) return mp_const_true;
+    
+    //which of two overlapping writes lands last would depend on the sort
+    for (size_t i = 1; op == WORK_WRITEV && i < nsegs; i++)
+        if (seg[i].block < seg[i - 1].block + seg[i - 1].nblocks) mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Overlapping Blocks"));
+    
+    if (self->worker != NULL) {
+        sdcard_worker_check(self, true);
+        mp_obj_t keep[2] = {reqs, mp_obj_new_bytearray_by_ref(nsegs * sizeof(sdcard_seg_t), seg)};
+        sdcard_worker_until(self, sdcard_worker_queue(self, op, 0, (uint8_t *)seg, nsegs, mp_obj_new_tuple(2, keep), true));
+        if (self->worker->sync_err) sdcard_raise(self->worker->sync_err);
+        return mp_const_true;
+    }
+    
+    sdcard_check_idle(self);
+    sdcard_indicate(self, true);
+    
+    if (op == WORK_READV) sdcard_io_readv(self, seg, nsegs);
+    else                  sdcard_io_writev(self, seg, nsegs);
+    
+    sdcard_indicate(self, false);
+    m_del(sdcard_seg_t, seg, nsegs);
+    return mp_const_true;
+}
+
+STATIC mp_obj_t SDObject_readv(mp_obj_t self_in, mp_obj_t reqs) {
+    return sdcard_vector(self_in, reqs, WORK_READV);
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(SDObject_readv_obj, SDObject_readv);
+
+STATIC mp_obj_t SDObject_writev(mp_obj_t self_in, mp_obj_t reqs) {
+    return sdcard_vector(self_in, reqs, WORK_WRITEV);
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(SDObject_writev_obj, SDObject_writev);
+
+//__> ERASE _____________________________________________________________________________________
+STATIC void sdcard_cache_discard(sdcard_cache_t *c, uint32_t blocknum, uint32_t nblocks) {
+    for (int i = 0; i < c->lines; i++) {
+        if (c->used[i] && c->tags[i] >= blocknum && c->tags[i] - blocknum < nblocks) {
+            c->used[i]  = 0;
+            c->dirty[i] = 0;
+        }
+    }
+}
+
+//for traffic that goes around the layers ~ queued blocks of the range land first, cached and prefetched copies are dropped
+STATIC void sdcard_forget(sdcard_SDObject_obj_t *self, uint32_t blocknum, uint32_t nblocks) {
+    sdcard_queue_settle(self, blocknum, nblocks);
+    if (self->cache.lines)  sdcard_cache_discard(&self->cache , blocknum, nblocks);
+    if (self->pinned.lines) sdcard_cache_discard(&self->pinned, blocknum, nblocks);
+    
+    sdcard_prefetch_t *pf = &self->prefetch;
+    if (pf->count && blocknum < pf->start + pf->count && pf->start < blocknum + nblocks) pf->count = 0;
+}
+
+//one CMD32/CMD33/CMD38 sequence ~ holds CS until the card stops signalling busy
+STATIC void sdcard_erase_range(sdcard_SDObject_obj_t *self, uint32_t first, uint32_t last) {
+    if (sdcard_cmd(self, CMD32, first*self->cdv)) sdcard_raise(5);
+    if (sdcard_cmd(self, CMD33, last*self->cdv))  sdcard_raise(5);
+    if (sdcard_cmd(self, CMD38, .hold=true)) {
+        gpio_put(self->cs, 1);
+        sdcard_raise(5);
+    }
+    
+    sdcard_wait_busy(self, self->wait.erase_us);
+    
+    gpio_put(self->cs, 1);
+    spi_write_blocking(self->spi, FF, 1);
+}
+
+//one allocation unit at a time ~ the caller has dropped the copies of the range
+STATIC void sdcard_erase_run(sdcard_SDObject_obj_t *self, uint32_t blocknum, uint32_t nblocks) {
+    uint64_t start = time_us_64();
+    uint32_t len   = nblocks * BLOCK;
+    while (nblocks) {
+        uint32_t n = self->au - (blocknum % self->au);
+        if (n > nblocks) n = nblocks;
+        
+        sdcard_erase_range(self, blocknum, blocknum + n - 1);
+        blocknum += n;
+        nblocks  -= n;
+    }
+    sdcard_stats_op(self, STAT_ERASE, len, start);
+}
+
+//erases [blocknum, blocknum + nblocks) ~ pending copies of that range are discarded
+STATIC void sdcard_erase(sdcard_SDObject_obj_t *self, uint32_t blocknum, uint32_t nblocks) {
+    if (!nblocks || (uint64_t)blocknum + nblocks > self->sectors) 
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid Block Range"));
+    
+    sdcard_check_idle(self);
+    sdcard_stream_release(self);
+    sdcard_forget(self, blocknum, nblocks);
+    sdcard_erase_run(self, blocknum, nblocks);
+}
+
+//sends the gathered erase ioctls as one erase
+STATIC void sdcard_erase_flush(sdcard_SDObject_obj_t *self) {
+    if (!self->erase_count) return;
+    
+    uint32_t count = self->erase_count;
+    self->erase_count = 0;
+    sdcard_stream_release(self);
+    sdcard_erase_run(self, self->erase_start, count);
+}
+
+//littlefs erases every block right before it programs it ~ ioctls that continue the pending range are gathered instead of sent
+STATIC void sdcard_erase_defer(sdcard_SDObject_obj_t *self, uint32_t blocknum) {
+    if (blocknum >= self->sectors) mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid Block Range"));
+    
+    sdcard_check_idle(self);
+    if (self->erase_count && blocknum != self->erase_start + self->erase_count) sdcard_erase_flush(self);
+    
+    //the block reads as erased from here on ~ copies of what it held are dropped now
+    sdcard_forget(self, blocknum, 1);
+    if (!self->erase_count) self->erase_start = blocknum;
+    self->erase_count++;
+}
+
+//before traffic on [blocknum, blocknum + nblocks) ~ a write replaces what the erase would leave, so the blocks it covers are dropped from the range
+//a read, or a write that splits the range, sends the erase first
+STATIC void sdcard_erase_settle(sdcard_SDObject_obj_t *self, uint32_t blocknum, uint32_t nblocks, bool write) {
+    uint32_t start = self->erase_start;
+    uint32_t end   = start + self->erase_count;
+    if (!self->erase_count || blocknum >= end || blocknum + nblocks <= start) return;
+    
+    if (write && blocknum <= start) {
+        self->erase_start = blocknum + nblocks;
+        self->erase_count = (blocknum + nblocks < end) ? end - (blocknum + nblocks) : 0;
+    }
+    else if (write && blocknum + nblocks >= end) self->erase_count = blocknum - start;
+    else sdcard_erase_flush(self);
+}
+
+STATIC mp_obj_t SDObject_erase(mp_obj_t self_in, mp_obj_t start_obj, mp_obj_t count_obj) {
+    sdcard_SDObject_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_int_t start = mp_obj_get_int(start_obj);
+    mp_int_t count = mp_obj_get_int(count_obj);
+    if (start < 0 || count < 1) mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid Block Range"));
+    
+    sdcard_indicate(self, true);
+    sdcard_erase(self, start, count);
+    sdcard_indicate(self, false);
+    return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(SDObject_erase_obj, SDObject_erase);
+
+
+//__> LOGGER _____________________________________________________________________________________
+//append-only writer over a raw block region ~ one CMD25 stays open and blocks leave a RAM ring as fast as the card takes them
+const mp_obj_type_t sdcard_SDLogger_type;
+
+typedef struct _sdcard_SDLogger_obj_t {
+    mp_obj_base_t base;
+    sdcard_SDObject_obj_t *sd;      //NULL once closed
+    uint32_t  start;        //first block of the region
+    uint32_t  nblocks;
+    uint32_t  position;     //region offset the next block goes to
+    uint8_t  *ring;         //capacity * BLOCK
+    uint32_t  capacity;
+    uint32_t  head;         //slot of the oldest block not sent yet
+    uint32_t  count;        //blocks not sent yet
+    bool      open;         //a CMD25 run is in progress at `position`
+    bool      busy;         //the card may still be programming the last block sent ~ polled, never waited on while appending
+    uint64_t  busy_since;
+    uint32_t  appended;     //blocks taken into the ring
+    uint32_t  written;      //blocks the card accepted
+    uint32_t  dropped;      //blocks turned away because the ring was full
+    uint32_t  overruns;     //appends that lost anything
+    uint32_t  high_water;   //most blocks the ring has held
+    uint32_t  wraps;
+    uint32_t  runs;         //CMD25 transactions
+    uint32_t  max_busy_us;  //longest the card stayed busy after a block
+} sdcard_SDLogger_obj_t;
+
+//starts a run at `position` ~ the card is told how much of the region is left so it can erase ahead
+STATIC void sdcard_logger_open(sdcard_SDLogger_obj_t *self) {
+    sdcard_SDObject_obj_t *sd = self->sd;
+    
+    //anything read or queued from the region since the last run is out of date once this one starts
+    sdcard_forget(sd, self->start, self->nblocks);
+    
+    uint32_t left = self->nblocks - self->position;
+    if (left >= PRE_ERASE_MIN) {
+        sdcard_cmd(sd, CMD55);
+        sdcard_cmd(sd, CMD23, left);
+    }
+    
+    if (sdcard_cmd(sd, CMD25, (self->start + self->position)*sd->cdv)) sdcard_raise(5);
+    self->open = true;
+    self->runs++;
+}
+
+//whether the card is done with the last block ~ one poll, or until it is with `wait`. CS must be asserted
+STATIC bool sdcard_logger_ready(sdcard_SDLogger_obj_t *self, bool wait) {
+    if (!self->busy) return true;
+    sdcard_SDObject_obj_t *sd = self->sd;
+    
+    if (wait) sdcard_wait_busy(sd, sd->wait.busy_us);
+    else spi_read_blocking(sd->spi, 0xFF, sd->token, 1);
+    
+    uint32_t waited = time_us_64() - self->busy_since;
+    if (!wait && !sd->token[0]) {
+        if (waited <= sd->wait.busy_us) return false;
+        gpio_put(sd->cs, 1);
+        spi_write_blocking(sd->spi, FF, 1);
+        sdcard_raise(110); // ETIMEDOUT
+    }
+    
+    self->busy = false;
+    if (waited > self->max_busy_us) self->max_busy_us = waited;
+    return true;
+}
+
+//ends the open run ~ the last block is waited out and the stop token waits out the rest
+STATIC void sdcard_logger_end(sdcard_SDLogger_obj_t *self) {
+    if (!self->open) return;
+    sdcard_SDObject_obj_t *sd = self->sd;
+    
+    sdcard_select(sd);
+    sdcard_logger_ready(self, true);
+    self->open = false;
+    sdcard_write_token(sd, TOKEN_STOP_TRAN);
+}
+
+STATIC void sdcard_logger_park(sdcard_SDObject_obj_t *sd) {
+    if (sd->logger != NULL) sdcard_logger_end(sd->logger);
+}
+
+//sends ring blocks while the card keeps up ~ `wait` empties the ring instead of returning at the first busy poll
+STATIC void sdcard_logger_pump(sdcard_SDLogger_obj_t *self, bool wait) {
+    sdcard_SDObject_obj_t *sd = self->sd;
+    if (!self->count) return;
+    
+    uint64_t start = time_us_64();
+    uint32_t sent  = 0;
+    int      tries = 0;
+    
+    sdcard_select(sd);
+    while (self->count && sdcard_logger_ready(self, wait)) {
+        if (!self->open) sdcard_logger_open(self);
+        
+        int response = sdcard_write_packet(sd, TOKEN_CMD25, self->ring + (self->head * BLOCK), BLOCK);
+        if (response != DATA_ACCEPTED) {
+            //the run is over either way ~ a CRC rejection sends the same block again in a new one
+            self->open = false;
+            sdcard_write_token(sd, TOKEN_STOP_TRAN);
+            if (response != DATA_CRC_ERROR) sdcard_raise(5);
+            sdcard_crc_again(sd, &tries);
+            sdcard_select(sd);
+            continue;
+        }
+        
+        self->busy       = true;
+        self->busy_since = time_us_64();
+        self->head       = (self->head + 1) % self->capacity;
+        self->count--;
+        self->written++;
+        sent++;
+        tries = 0;
+        
+        //the end of the region closes the run ~ the next block starts over at the front
+        if (++self->position == self->nblocks) {
+            sdcard_logger_end(self);
+            self->position = 0;
+            self->wraps++;
+            sdcard_select(sd);
+        }
+    }
+    
+    //the card stays in its run with CS up ~ asserting CS again shows where busy left off
+    gpio_put(sd->cs, 1);
+    spi_write_blocking(sd->spi, FF, 1);
+    sdcard_stats_op(sd, STAT_WRITE, sent * BLOCK, start);
+}
+
+STATIC void sdcard_logger_close(sdcard_SDLogger_obj_t *self) {
+    sdcard_SDObject_obj_t *sd = self->sd;
+    if (sd == NULL) return;
+    
+    sdcard_logger_pump(self, true);
+    sdcard_logger_end(self);
+    sdcard_indicate(sd, false);
+    self->sd   = NULL;
+    sd->logger = NULL;
+    m_del(uint8_t, self->ring, self->capacity * BLOCK);
+    self->ring = NULL;
+}
+
+STATIC sdcard_SDLogger_obj_t *sdcard_logger_get(mp_obj_t self_in) {
+    sdcard_SDLogger_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->sd == NULL) mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Logger Closed"));
+    sdcard_check_idle(self->sd);
+    return self;
+}
+
+STATIC mp_obj_t SDObject_logger(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum {ARG_start, ARG_count, ARG_ring};
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_start     , MP_ARG_REQUIRED | MP_ARG_INT, {.u_int = 0}},
+        { MP_QSTR_count     , MP_ARG_REQUIRED | MP_ARG_INT, {.u_int = 0}},
+        { MP_QSTR_ring      , MP_ARG_INT                  , {.u_int = LOGGER_RING}},
+    };
+    
+    sdcard_SDObject_obj_t *self = MP_OBJ_TO_PTR(pos_args[0]);
+    mp_arg_val_t kw[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, kw);
+    
+    mp_int_t start = kw[ARG_start].u_int;
+    mp_int_t count = kw[ARG_count].u_int;
+    if (start < 0 || count < 1 || (uint64_t)(start + count) > self->sectors) 
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid Block Range"));
+    if (kw[ARG_ring].u_int < 1) mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid Ring Size"));
+    
+    sdcard_check_idle(self);
+    if (self->logger != NULL) sdcard_logger_close(self->logger);
+    
+    //the region is written around the layers ~ what they hold has to reach the card first
+    sdcard_io_sync(self);
+    
+    sdcard_SDLogger_obj_t *logger = m_new_obj(sdcard_SDLogger_obj_t);
+    memset(logger, 0, sizeof(sdcard_SDLogger_obj_t));
+    logger->base.type = &sdcard_SDLogger_type;
+    logger->sd        = self;
+    logger->start     = start;
+    logger->nblocks   = count;
+    logger->capacity  = kw[ARG_ring].u_int;
+    logger->ring      = m_new(uint8_t, logger->capacity * BLOCK);
+    
+    self->logger = logger;
+    sdcard_indicate(self, true);
+    return MP_OBJ_FROM_PTR(logger);
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(SDObject_logger_obj, 3, SDObject_logger);
+
+//copies whole blocks into the ring and sends what the card will take without waiting ~ returns the bytes kept, anything past a full ring is dropped
+STATIC mp_obj_t SDLogger_append(mp_obj_t self_in, mp_obj_t buf) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buf, &bufinfo, MP_BUFFER_READ);
+    if ((!(bufinfo.len/BLOCK)) || (bufinfo.len%BLOCK)) mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid Buffer Length"));
+    
+    sdcard_SDLogger_obj_t *self = sdcard_logger_get(self_in);
+    const uint8_t *src = bufinfo.buf;
+    uint32_t n = bufinfo.len / BLOCK, kept = 0;
     
-    bool found = false;
-    for (int i=0; i < 5; i++) {
-        if (sdcard_cmd(self, CMD0, 0, 0x95) == IDLE_STATE) {
-            found = true;
-            break;
+    while (kept < n) {
+        //a full ring gets one chance to drain
+        if (self->count == self->capacity) {
+            sdcard_logger_pump(self, false);
+            if (self->count == self->capacity) break;
         }
+        
+        uint32_t slot = (self->head + self->count) % self->capacity;
+        memcpy(self->ring + (slot * BLOCK), src + (kept * BLOCK), BLOCK);
+        self->count++;
+        kept++;
+        if (self->count > self->high_water) self->high_water = self->count;
     }
     
-    if (!found) mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("No Card")); 
-    
-    int r1 = sdcard_cmd(self, CMD8, 0x0001AA, 0x87, 4);
+    self->appended += kept;
+    if (kept < n) {
+        self->dropped += n - kept;
+        self->overruns++;
+    }
     
-    if      (r1 == IDLE_STATE)                  sdcard_init_v2(self);
-    else if (r1 == (IDLE_STATE | ILLEGAL_CMD))  sdcard_init_v1(self);
-    else    mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Unknown Version"));
+    sdcard_logger_pump(self, false);
+    return mp_obj_new_int_from_uint(kept * BLOCK);
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(SDLogger_append_obj, SDLogger_append);
+
+//sends what the card will take without waiting ~ for loops that produce nothing this time around. returns the blocks still in the ring
+STATIC mp_obj_t SDLogger_pump(mp_obj_t self_in) {
+    sdcard_SDLogger_obj_t *self = sdcard_logger_get(self_in);
+    sdcard_logger_pump(self, false);
+    return mp_obj_new_int_from_uint(self->count);
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(SDLogger_pump_obj, SDLogger_pump);
+
+//everything in the ring reaches the card and the run is closed ~ the next append starts a new one where this left off
+STATIC mp_obj_t SDLogger_flush(mp_obj_t self_in) {
+    sdcard_SDLogger_obj_t *self = sdcard_logger_get(self_in);
+    sdcard_logger_pump(self, true);
+    sdcard_logger_end(self);
+    return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(SDLogger_flush_obj, SDLogger_flush);
+
+STATIC mp_obj_t SDLogger_close(mp_obj_t self_in) {
+    sdcard_SDLogger_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->sd != NULL) {
+        sdcard_check_idle(self->sd);
+        sdcard_logger_close(self);
+    }
+    return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(SDLogger_close_obj, SDLogger_close);
+
+//where the region stands and what the card cost ~ `dropped` and `overruns` count blocks lost to a stalled card
+STATIC mp_obj_t SDLogger_info(mp_obj_t self_in) {
+    sdcard_SDLogger_obj_t *self = MP_OBJ_TO_PTR(self_in);
     
-    if (sdcard_cmd(self, CMD9, .hold=true)) mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("No Response"));
-            
-    uint8_t csd[16] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
-    sdcard_readinto(self, csd, 16);
+    mp_obj_t info = mp_obj_new_dict(14);
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_start)      , mp_obj_new_int_from_uint(self->start));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_count)      , mp_obj_new_int_from_uint(self->nblocks));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_position)   , mp_obj_new_int_from_uint(self->position));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_wraps)      , mp_obj_new_int_from_uint(self->wraps));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_ring)       , mp_obj_new_int_from_uint(self->capacity));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_pending)    , mp_obj_new_int_from_uint(self->count));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_high_water) , mp_obj_new_int_from_uint(self->high_water));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_appended)   , mp_obj_new_int_from_uint(self->appended));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_written)    , mp_obj_new_int_from_uint(self->written));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_dropped)    , mp_obj_new_int_from_uint(self->dropped));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_overruns)   , mp_obj_new_int_from_uint(self->overruns));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_runs)       , mp_obj_new_int_from_uint(self->runs));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_max_busy_us), mp_obj_new_int_from_uint(self->max_busy_us));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_open)       , mp_obj_new_bool(self->sd != NULL));
+    return info;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(SDLogger_info_obj, SDLogger_info);
+
+STATIC const mp_rom_map_elem_t SDLogger_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_append), MP_ROM_PTR(&SDLogger_append_obj) },
+    { MP_ROM_QSTR(MP_QSTR_pump)  , MP_ROM_PTR(&SDLogger_pump_obj)   },
+    { MP_ROM_QSTR(MP_QSTR_flush) , MP_ROM_PTR(&SDLogger_flush_obj)  },
+    { MP_ROM_QSTR(MP_QSTR_close) , MP_ROM_PTR(&SDLogger_close_obj)  },
+    { MP_ROM_QSTR(MP_QSTR_info)  , MP_ROM_PTR(&SDLogger_info_obj)   },
+};
+
+STATIC MP_DEFINE_CONST_DICT(SDLogger_locals_dict, SDLogger_locals_dict_table);
+
+const mp_obj_type_t sdcard_SDLogger_type = {
+    { &mp_type_type },
+    .name        = MP_QSTR_SDLogger,
+    .locals_dict = (mp_obj_dict_t*)&SDLogger_locals_dict,
+};
+
+//__> ASYNC _____________________________________________________________________________________
+//awaitable block I/O ~ the card is polled for a slice of spin_us at a time and uasyncio runs other tasks in between
+const mp_obj_type_t sdcard_SDAwait_type;
+
+typedef struct _sdcard_SDAwait_obj_t {
+    mp_obj_base_t base;
+    sdcard_SDObject_obj_t *sd;
+    uint8_t   op;           //AIO_READ or AIO_WRITE
+    uint8_t   phase;
+    bool      single;       //the run is CMD17/CMD24
+    bool      bounded;      //the run was counted with CMD23
+    bool      open;         //the run can still take (or give) data blocks
+    int       tries;        //CRC retries used
+    uint32_t  blocknum;
+    uint32_t  nblocks;
+    uint32_t  done;         //blocks transferred
+    uint64_t  deadline;     //end of the current wait
+    uint64_t  started;      //when the card was claimed
+    uint8_t  *buf;
+    mp_obj_t  buf_obj;      //keeps buf alive
+    mp_obj_t  sleep;        //uasyncio.sleep_ms
+} sdcard_SDAwait_obj_t;
+
+STATIC void sdcard_aio_enter(sdcard_SDAwait_obj_t *self, uint8_t phase, uint32_t budget_us) {
+    self->phase    = phase;
+    self->deadline = time_us_64() + budget_us;
+}
+
+//polls for `kind` until it is met or the slice is used up ~ false means come back later. raises past the deadline
+STATIC bool sdcard_aio_poll(sdcard_SDAwait_obj_t *self, uint8_t kind, uint64_t slice) {
+    sdcard_SDObject_obj_t *sd = self->sd;
+    uint64_t start = time_us_64();
+    uint32_t polls = 0;
     
-    if ((csd[0] & 0xC0) == 0x40) self->sectors = ((csd[8] << 8 | csd[9]) + 1) * 1024;   // CSD version 2.0
-    else if ((csd[0] & 0xC0) == 0x00) {                                                 // CSD version 1.0 (old, <=2GB)
-        uint16_t c_size       = (csd[6] & 0x3) | (csd[7] << 2) | ((csd[8] & 0xC0) << 4);
-        uint16_t c_size_mult  = ((csd[9] & 0x3) << 1) | (csd[10] >> 7);
-        self->sectors = (c_size + 1) * pow(2, (c_size_mult + 2));
-    }
-    else mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("CSD Format Unsupported"));
+    for (;;) {
+        spi_read_blocking(sd->spi, 0xFF, sd->token, 1);
+        polls++;
+        if (sdcard_wait_met(kind, sd->token[0])) {
+            sd->wait.waits++;
+            sdcard_stats_wait(sd, kind, time_us_64() - start);
+            if (sd->trace.capacity) sdcard_trace_polls(sd, polls);
+            return true;
+        }
         
-     
-    if (sdcard_cmd(self, CMD16, BLOCK) != 0) mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Can't Set Block Size"));
+        //only the polling counts as waiting ~ the time between slices belongs to other tasks
+        uint64_t now = time_us_64();
+        if (now >= slice || now >= self->deadline) {
+            sdcard_stats_wait(sd, kind, now - start);
+            if (sd->trace.capacity) sdcard_trace_polls(sd, polls);
+        }
+        if (now >= self->deadline) {
+            sd->wait.timeouts++;
+            sd->stats.timeouts++;
+            if (kind == WAIT_TOKEN) mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Response Timeout"));
+            mp_raise_OSError(110); // ETIMEDOUT
+        }
+        if (now >= slice) return false;
+    }
+}
 
-    spi_set_baudrate(self->spi, kw[ARG_baudrate].u_int);
+//ends a read run ~ a counted run that got all its blocks ends by itself, anything else needs CMD12
+STATIC void sdcard_aio_end_read(sdcard_SDAwait_obj_t *self) {
+    sdcard_SDObject_obj_t *sd = self->sd;
+    self->open = false;
+    if (self->single) return;
     
-    //mp_printf(MP_PYTHON_PRINTER, "card ready\n");
-    return MP_OBJ_FROM_PTR(self);
+    if (self->bounded && self->done == self->nblocks) {
+        gpio_put(sd->cs, 1);
+        spi_write_blocking(sd->spi, FF, 1);
+    } 
+    else if (sdcard_cmd(sd, CMD12, 0, 0xFF, .skip=true) && !self->bounded) mp_raise_OSError(5);
 }
 
-STATIC void sdcard_indicate(sdcard_SDObject_obj_t *self, bool on) {
-    if (self->led > -1) gpio_put(self->led, on);
+//ends a write transaction ~ with `defer` the programming is left to whatever talks to the card next
+STATIC void sdcard_aio_end_write(sdcard_SDAwait_obj_t *self) {
+    sdcard_SDObject_obj_t *sd = self->sd;
+    self->open = false;
+    
+    if (sd->wait.defer) {
+        sd->wait.pending = true;
+        sd->wait.deferred++;
+        gpio_put(sd->cs, 1);
+        spi_write_blocking(sd->spi, FF, 1);
+        if (self->done == self->nblocks) self->phase = AIO_DONE;
+        else sdcard_aio_enter(self, AIO_SETTLE, sd->wait.busy_us);
+    } 
+    else sdcard_aio_enter(self, AIO_BUSY, sd->wait.busy_us);
 }
 
+STATIC void sdcard_aio_stop_tran(sdcard_SDAwait_obj_t *self) {
+    sdcard_SDObject_obj_t *sd = self->sd;
+    if (sd->trace.capacity) sdcard_trace_cmd(sd, TOKEN_STOP_TRAN, 0);
+    sdcard_select(sd);
+    spi_read_blocking(sd->spi, TOKEN_STOP_TRAN, sd->token, 1);
+    spi_write_blocking(sd->spi, FF, 1);
+    sdcard_aio_end_write(self);
+}
 
-//__> READ BLOCKS _____________________________________________________________________________________
-STATIC void sdcard_readblocks(sdcard_SDObject_obj_t *self, int blocknum, uint8_t *buf, int len) {
-    // mp_printf(MP_PYTHON_PRINTER, "readblocks\n");
-    uint64_t nblocks = len/BLOCK;
-    if ((!nblocks) || (len%BLOCK)) mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid Buffer Length"));
+//the caches only ever saw the range through the card ~ reads pick up dirty lines, writes refresh every copy
+STATIC void sdcard_aio_land(sdcard_SDAwait_obj_t *self) {
+    sdcard_SDObject_obj_t *sd = self->sd;
+    sdcard_cache_t *caches[2] = {&sd->cache, &sd->pinned};
     
-    if (nblocks == 1) {
-        if (sdcard_cmd(self, CMD17, blocknum*self->cdv, .hold=true)) {
-            gpio_put(self->cs, 1);
-            mp_raise_OSError(5);
-        }
-                
-        sdcard_readinto(self, buf, BLOCK);
-    }
-    else {
-        if (sdcard_cmd(self, CMD18, blocknum*self->cdv, .hold=true)) {
-            gpio_put(self->cs, 1);
-            mp_raise_OSError(5);
-        }
+    for (uint32_t i = 0; i < self->nblocks; i++) {
+        uint8_t *buf = self->buf + (i * BLOCK);
+        
+        for (int k = 0; k < 2; k++) {
+            sdcard_cache_t *c = caches[k];
+            int line = c->lines ? sdcard_cache_find(c, self->blocknum + i) : -1;
+            if (line < 0) continue;
             
-        slice_obj_t b;
-        for (int i=0; i<nblocks; i++) {
-            b = slice(buf, len, BLOCK+(BLOCK*(i-1)), BLOCK+(BLOCK*i));
-            sdcard_readinto(self, b.buff, BLOCK);
+            if (self->op == AIO_WRITE) {
+                memcpy(c->data + (line * BLOCK), buf, BLOCK);
+                c->dirty[line] = 0;
+            } 
+            else if (c->dirty[line]) memcpy(buf, c->data + (line * BLOCK), BLOCK);
         }
-            
-        if (sdcard_cmd(self, CMD12, 0, 0xFF, .skip=true)) mp_raise_OSError(5);
     }
     
+    if (self->op == AIO_WRITE && sd->prefetch.count) sdcard_prefetch_write(&sd->prefetch, self->blocknum, self->buf, self->nblocks);
 }
 
-STATIC mp_obj_t SDObject_readblocks(mp_obj_t self_in, mp_obj_t block_num, mp_obj_t buf) {
-    sdcard_SDObject_obj_t *self = MP_OBJ_TO_PTR(self_in);
-    mp_buffer_info_t bufinfo;
-    sdcard_indicate(self, true);
+//lets go of the card after an error or a cancel ~ an open run is ended so the card listens to the next command
+STATIC void sdcard_aio_abort(sdcard_SDAwait_obj_t *self) {
+    sdcard_SDObject_obj_t *sd = self->sd;
+    if (sd->aio != self) return;
     
-    mp_get_buffer_raise(buf, &bufinfo, MP_BUFFER_WRITE);
-    sdcard_readblocks(self, mp_obj_get_int(block_num), bufinfo.buf, bufinfo.len);
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        if (self->open && !self->single) {
+            if (self->op == AIO_READ) sdcard_cmd(sd, CMD12, 0, 0xFF, .skip=true);
+            else {
+                sdcard_select(sd);
+                spi_read_blocking(sd->spi, TOKEN_STOP_TRAN, sd->token, 1);
+                spi_write_blocking(sd->spi, FF, 1);
+            }
+        }
+        nlr_pop();
+    }
     
-    sdcard_indicate(self, false);
-    //errors are handled manually in sdcard_readblocks ~ if we got this far there was no error
-    return mp_const_true;
+    //a write may have left the card programming ~ the next command waits it out
+    if (self->op == AIO_WRITE) sd->wait.pending = true;
+    
+    gpio_put(sd->cs, 1);
+    spi_write_blocking(sd->spi, FF, 1);
+    self->open  = false;
+    self->phase = AIO_DONE;
+    sd->aio     = NULL;
+    sdcard_indicate(sd, false);
 }
 
-STATIC MP_DEFINE_CONST_FUN_OBJ_3(SDObject_readblocks_obj, SDObject_readblocks);
-
-//__> WRITE BLOCKS _____________________________________________________________________________________
-STATIC void sdcard_writeblocks(sdcard_SDObject_obj_t *self, int blocknum, uint8_t *buf, int len) {
-    //mp_printf(MP_PYTHON_PRINTER, "writeblocks\n");
-    uint64_t nblocks = len/BLOCK;
-    if ((!nblocks) || (len%BLOCK)) mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid Buffer Length"));
+//runs the transfer for one slice ~ true means it yielded with more to do
+STATIC bool sdcard_aio_step(sdcard_SDAwait_obj_t *self) {
+    sdcard_SDObject_obj_t *sd = self->sd;
+    uint64_t slice = time_us_64() + sd->wait.spin_us;
     
-    if (nblocks == 1) {
-        if (sdcard_cmd(self, CMD24, blocknum*self->cdv)) mp_raise_OSError(5);
+    for (;;) {
+        switch (self->phase) {
+            case AIO_CLAIM:
+                //another awaitable holds this card or the bus ~ this one waits its turn instead of failing
+                if (sd->aio != NULL || sdcard_bus_busy(sd)) return true;
+                sdcard_check_idle(sd);
+                sdcard_stream_release(sd);
+                sdcard_erase_settle(sd, self->blocknum, self->nblocks, self->op == AIO_WRITE);
+                sdcard_queue_settle(sd, self->blocknum, self->nblocks);
+                sd->aio = self;
+                self->started = time_us_64();
+                sdcard_indicate(sd, true);
+                sdcard_aio_enter(self, AIO_SETTLE, sd->wait.busy_us);
+                break;
                 
-        sdcard_write(self, TOKEN_DATA, buf, len);
-    }
-    else {
-        if (sdcard_cmd(self, CMD25, blocknum*self->cdv)) mp_raise_OSError(5);
+            case AIO_SETTLE:
+                //a deferred write finishes programming before the card takes anything new
+                if (sd->wait.pending) {
+                    sdcard_select(sd);
+                    if (!sdcard_aio_poll(self, WAIT_BUSY, slice)) return true;
+                    sd->wait.pending = false;
+                    gpio_put(sd->cs, 1);
+                    spi_write_blocking(sd->spi, FF, 1);
+                }
+                
+                if (self->done == self->nblocks) {
+                    self->phase = AIO_DONE;
+                    return false;
+                }
+                self->phase = AIO_START;
+                break;
+                
+            case AIO_START: {
+                uint32_t n   = self->nblocks - self->done;
+                uint32_t lba = (self->blocknum + self->done) * sd->cdv;
+                self->single  = (n == 1);
+                self->bounded = !self->single && sdcard_set_count(sd, n);
+                
+                if (self->op == AIO_READ) {
+                    if (sdcard_cmd(sd, self->single ? CMD17 : CMD18, lba, .hold=true)) {
+                        gpio_put(sd->cs, 1);
+                        mp_raise_OSError(5);
+                    }
+                    self->open = true;
+                    sdcard_aio_enter(self, AIO_TOKEN, sd->wait.token_us);
+                } else {
+                    if (!self->single && !self->bounded && n >= PRE_ERASE_MIN) {
+                        sdcard_cmd(sd, CMD55);
+                        sdcard_cmd(sd, CMD23, n);
+                    }
+                    if (sdcard_cmd(sd, self->single ? CMD24 : CMD25, lba)) mp_raise_OSError(5);
+                    self->open  = true;
+                    self->phase = AIO_SEND;
+                }
+                break;
+            }
             
-        slice_obj_t b;
-        for (int i=0; i<nblocks; i++) {
-            b = slice(buf, len, BLOCK+(BLOCK*(i-1)), BLOCK+(BLOCK*i));
-            sdcard_write(self, TOKEN_CMD25, b.buff, BLOCK);
-        }
+            case AIO_TOKEN: {
+                sdcard_select(sd);
+                if (!sdcard_aio_poll(self, WAIT_TOKEN, slice)) return true;
+                if (sd->token[0] != TOKEN_DATA) mp_raise_OSError(5);
+                
+                uint8_t *buf = self->buf + (self->done * BLOCK);
+                sdcard_data_read(sd, buf, BLOCK);
+                
+                if (!sdcard_data_end(sd, buf, BLOCK, !self->single)) {
+                    //a bad block ends the run ~ a new one starts from that block
+                    sdcard_aio_end_read(self);
+                    sdcard_crc_again(sd, &self->tries);
+                    self->phase = AIO_START;
+                    break;
+                }
+                
+                if (++self->done == self->nblocks) {
+                    sdcard_aio_end_read(self);
+                    self->phase = AIO_DONE;
+                    return false;
+                }
+                
+                sdcard_aio_enter(self, AIO_TOKEN, sd->wait.token_us);
+                if (time_us_64() >= slice) return true;
+                break;
+            }
             
-        if (sdcard_cmd(self, CMD12, 0, 0xFF, .skip=true)) mp_raise_OSError(5);
+            case AIO_SEND: {
+                int response = sdcard_write_packet(sd, self->single ? TOKEN_DATA : TOKEN_CMD25, self->buf + (self->done * BLOCK), BLOCK);
+                
+                if (response != DATA_ACCEPTED) {
+                    //only a CRC error is worth another try ~ anything else raises and the abort stops the run
+                    if (response != DATA_CRC_ERROR) mp_raise_OSError(5);
+                    sdcard_crc_again(sd, &self->tries);
+                    if (self->single) {
+                        self->open = false;
+                        sdcard_aio_enter(self, AIO_SETTLE, sd->wait.busy_us);
+                    } 
+                    else sdcard_aio_stop_tran(self);
+                    break;
+                }
+                
+                //a counted run ends by itself after its last block ~ that block ends the transaction
+                self->done++;
+                if (self->single || (self->bounded && self->done == self->nblocks)) sdcard_aio_end_write(self);
+                else sdcard_aio_enter(self, AIO_BUSY, sd->wait.busy_us);
+                break;
+            }
             
-        sdcard_write_token(self, TOKEN_STOP_TRAN);
+            case AIO_BUSY:
+                if (!sdcard_aio_poll(self, WAIT_BUSY, slice)) return true;
+                
+                if (self->open) {
+                    //an open run that took everything still needs the stop token
+                    if (self->done == self->nblocks) sdcard_aio_stop_tran(self);
+                    else                             self->phase = AIO_SEND;
+                    if (time_us_64() >= slice) return true;
+                    break;
+                }
+                
+                gpio_put(sd->cs, 1);
+                spi_write_blocking(sd->spi, FF, 1);
+                sdcard_aio_enter(self, AIO_SETTLE, sd->wait.busy_us);
+                break;
+                
+            default:
+                return false;
+        }
     }
 }
 
-STATIC mp_obj_t SDObject_writeblocks(mp_obj_t self_in, mp_obj_t block_num, mp_obj_t buf) {
-    sdcard_SDObject_obj_t *self = MP_OBJ_TO_PTR(self_in);
-    mp_buffer_info_t bufinfo;
-    sdcard_indicate(self, true);
+STATIC mp_obj_t SDAwait_iternext(mp_obj_t self_in) {
+    sdcard_SDAwait_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->phase == AIO_DONE) return MP_OBJ_STOP_ITERATION;
+    
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        bool more = sdcard_aio_step(self);
+        
+        //uasyncio.sleep_ms(0) hands back a generator whose first step queues the current task again
+        if (more) {
+            self->sd->wait.yields++;
+            mp_iternext(mp_call_function_1(self->sleep, MP_OBJ_NEW_SMALL_INT(0)));
+        }
+        nlr_pop();
+        if (more) return mp_const_none;
+    } else {
+        sdcard_aio_abort(self);
+        nlr_jump(nlr.ret_val);
+    }
+    
+    sdcard_aio_land(self);
+    sdcard_stats_op(self->sd, (self->op == AIO_READ) ? STAT_READ : STAT_WRITE, self->nblocks * BLOCK, self->started);
+    self->sd->aio = NULL;
+    sdcard_indicate(self->sd, false);
+    return MP_OBJ_STOP_ITERATION;
+}
 
-    mp_get_buffer_raise(buf, &bufinfo, MP_BUFFER_READ);
-    sdcard_writeblocks(self, mp_obj_get_int(block_num), bufinfo.buf, bufinfo.len);
+//uasyncio throws CancelledError into the awaitable ~ the card is let go before it goes on
+STATIC mp_obj_t SDAwait_throw(size_t n_args, const mp_obj_t *args) {
+    sdcard_SDAwait_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    sdcard_aio_abort(self);
+    nlr_raise(mp_make_raise_obj((n_args > 2) ? args[2] : args[1]));
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(SDAwait_throw_obj, 2, 4, SDAwait_throw);
+
+STATIC mp_obj_t SDAwait_close(mp_obj_t self_in) {
+    sdcard_aio_abort(MP_OBJ_TO_PTR(self_in));
+    return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(SDAwait_close_obj, SDAwait_close);
+
+STATIC const mp_rom_map_elem_t SDAwait_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_throw), MP_ROM_PTR(&SDAwait_throw_obj) },
+    { MP_ROM_QSTR(MP_QSTR_close), MP_ROM_PTR(&SDAwait_close_obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(SDAwait_locals_dict, SDAwait_locals_dict_table);
+
+const mp_obj_type_t sdcard_SDAwait_type = {
+    { &mp_type_type },
+    .name        = MP_QSTR_SDAwait,
+    .getiter     = mp_identity_getiter,
+    .iternext    = SDAwait_iternext,
+    .locals_dict = (mp_obj_dict_t*)&SDAwait_locals_dict,
+};
+
+//nothing touches the card until the first resume ~ uasyncio has to be importable
+STATIC mp_obj_t sdcard_aio_new(mp_obj_t self_in, uint8_t op, mp_obj_t block_num, mp_obj_t buf) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buf, &bufinfo, (op == AIO_READ) ? MP_BUFFER_WRITE : MP_BUFFER_READ);
+    if ((!(bufinfo.len/BLOCK)) || (bufinfo.len%BLOCK)) mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid Buffer Length"));
     
-    sdcard_indicate(self, false);
-    //errors are handled manually in sdcard_writeblocks ~ if we got this far there was no error
-    return mp_const_true;
+    mp_obj_t uasyncio = mp_import_name(MP_QSTR_uasyncio, mp_const_none, MP_OBJ_NEW_SMALL_INT(0));
+    
+    sdcard_SDAwait_obj_t *self = m_new_obj(sdcard_SDAwait_obj_t);
+    self->base.type = &sdcard_SDAwait_type;
+    self->sd        = MP_OBJ_TO_PTR(self_in);
+    self->op        = op;
+    self->phase     = AIO_CLAIM;
+    self->single    = self->bounded = self->open = false;
+    self->tries     = 0;
+    self->blocknum  = mp_obj_get_int(block_num);
+    self->nblocks   = bufinfo.len/BLOCK;
+    self->done      = 0;
+    self->deadline  = 0;
+    self->buf       = bufinfo.buf;
+    self->buf_obj   = buf;
+    self->sleep     = mp_load_attr(uasyncio, MP_QSTR_sleep_ms);
+    return MP_OBJ_FROM_PTR(self);
 }
 
-STATIC MP_DEFINE_CONST_FUN_OBJ_3(SDObject_writeblocks_obj, SDObject_writeblocks);
+STATIC mp_obj_t SDObject_areadblocks(mp_obj_t self_in, mp_obj_t block_num, mp_obj_t buf) {
+    return sdcard_aio_new(self_in, AIO_READ, block_num, buf);
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(SDObject_areadblocks_obj, SDObject_areadblocks);
+
+STATIC mp_obj_t SDObject_awriteblocks(mp_obj_t self_in, mp_obj_t block_num, mp_obj_t buf) {
+    return sdcard_aio_new(self_in, AIO_WRITE, block_num, buf);
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(SDObject_awriteblocks_obj, SDObject_awriteblocks);
+
 
 //__> IOCTL _____________________________________________________________________________________
 STATIC mp_obj_t SDObject_ioctl(mp_obj_t self_in, mp_obj_t cmd_obj, mp_obj_t arg_obj) {
@@ -432,15 +3615,22 @@ STATIC mp_obj_t SDObject_ioctl(mp_obj_t self_in, mp_obj_t cmd_obj, mp_obj_t arg_
     mp_int_t cmd = mp_obj_get_int(cmd_obj);
     switch (cmd) {
         case IOCTL_INIT:
+            if (self->use_worker && self->worker == NULL) sdcard_worker_start(self);
             return MP_OBJ_NEW_SMALL_INT(0); // success
         case IOCTL_DEINIT:
+            sdcard_io_sync(self);
+            sdcard_worker_stop(self);      //core1 lets go of the bus until the card is mounted again
             return MP_OBJ_NEW_SMALL_INT(0); // success
         case IOCTL_SYNC:
+            sdcard_io_sync(self);
             return MP_OBJ_NEW_SMALL_INT(0); // success
         case IOCTL_BLK_COUNT:
             return MP_OBJ_NEW_SMALL_INT(self->sectors);
         case IOCTL_BLK_SIZE:
             return MP_OBJ_NEW_SMALL_INT(BLOCK);
+        case IOCTL_BLK_ERASE:
+            sdcard_erase_defer(self, mp_obj_get_int(arg_obj));
+            return MP_OBJ_NEW_SMALL_INT(0); // success
         default:
             return MP_OBJ_NEW_SMALL_INT(-1); // error
     }
@@ -448,6 +3638,18 @@ STATIC mp_obj_t SDObject_ioctl(mp_obj_t self_in, mp_obj_t cmd_obj, mp_obj_t arg_
 
 STATIC MP_DEFINE_CONST_FUN_OBJ_3(SDObject_ioctl_obj, SDObject_ioctl);
 
+//__> DEL _____________________________________________________________________________________
+STATIC mp_obj_t SDObject_del(mp_obj_t self_in) {
+    sdcard_SDObject_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    sdcard_worker_stop(self);
+    sdcard_dma_deinit(self);
+    if (self->queue.alarm) cancel_alarm(self->queue.alarm);
+    sdcard_bus_detach(self);
+    return mp_const_none;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(SDObject_del_obj, SDObject_del);
+
 
 STATIC const mp_rom_map_elem_t SDObject_locals_dict_table[] = {
     /* None of this will ever be reached
@@ -470,12 +3672,119 @@ STATIC void SDObject_attr(mp_obj_t self_in, qstr attr, mp_obj_t *dest) {
             dest[0] = MP_OBJ_FROM_PTR(&SDObject_readblocks_obj);
             dest[1] = self;  
         }
+        else if (attr == MP_QSTR_readv) {
+            dest[0] = MP_OBJ_FROM_PTR(&SDObject_readv_obj);
+            dest[1] = self;  
+        }
+        else if (attr == MP_QSTR_writev) {
+            dest[0] = MP_OBJ_FROM_PTR(&SDObject_writev_obj);
+            dest[1] = self;  
+        }
         else if (attr == MP_QSTR_ioctl) {
             dest[0] = MP_OBJ_FROM_PTR(&SDObject_ioctl_obj);
             dest[1] = self;  
         }
+        else if (attr == MP_QSTR_stream) {
+            dest[0] = MP_OBJ_FROM_PTR(&SDObject_stream_obj);
+            dest[1] = self;  
+        }
+        else if (attr == MP_QSTR_logger) {
+            dest[0] = MP_OBJ_FROM_PTR(&SDObject_logger_obj);
+            dest[1] = self;  
+        }
+        else if (attr == MP_QSTR_cache_info) {
+            dest[0] = MP_OBJ_FROM_PTR(&SDObject_cache_info_obj);
+            dest[1] = self;  
+        }
+        else if (attr == MP_QSTR_prefetch_info) {
+            dest[0] = MP_OBJ_FROM_PTR(&SDObject_prefetch_info_obj);
+            dest[1] = self;  
+        }
+        else if (attr == MP_QSTR_pin_info) {
+            dest[0] = MP_OBJ_FROM_PTR(&SDObject_pin_info_obj);
+            dest[1] = self;  
+        }
+        else if (attr == MP_QSTR_queue_info) {
+            dest[0] = MP_OBJ_FROM_PTR(&SDObject_queue_info_obj);
+            dest[1] = self;  
+        }
+        else if (attr == MP_QSTR_flush) {
+            dest[0] = MP_OBJ_FROM_PTR(&SDObject_flush_obj);
+            dest[1] = self;  
+        }
+        else if (attr == MP_QSTR_crc_info) {
+            dest[0] = MP_OBJ_FROM_PTR(&SDObject_crc_info_obj);
+            dest[1] = self;  
+        }
+        else if (attr == MP_QSTR_wait) {
+            dest[0] = MP_OBJ_FROM_PTR(&SDObject_wait_obj);
+            dest[1] = self;  
+        }
+        else if (attr == MP_QSTR_erase) {
+            dest[0] = MP_OBJ_FROM_PTR(&SDObject_erase_obj);
+            dest[1] = self;  
+        }
+        else if (attr == MP_QSTR_stats) {
+            dest[0] = MP_OBJ_FROM_PTR(&SDObject_stats_obj);
+            dest[1] = self;  
+        }
+        else if (attr == MP_QSTR_trace) {
+            dest[0] = MP_OBJ_FROM_PTR(&SDObject_trace_obj);
+            dest[1] = self;  
+        }
+        else if (attr == MP_QSTR_bus_info) {
+            dest[0] = MP_OBJ_FROM_PTR(&SDObject_bus_info_obj);
+            dest[1] = self;  
+        }
+        else if (attr == MP_QSTR_areadblocks) {
+            dest[0] = MP_OBJ_FROM_PTR(&SDObject_areadblocks_obj);
+            dest[1] = self;  
+        }
+        else if (attr == MP_QSTR_awriteblocks) {
+            dest[0] = MP_OBJ_FROM_PTR(&SDObject_awriteblocks_obj);
+            dest[1] = self;  
+        }
+        else if (attr == MP_QSTR_submit_read) {
+            dest[0] = MP_OBJ_FROM_PTR(&SDObject_submit_read_obj);
+            dest[1] = self;  
+        }
+        else if (attr == MP_QSTR_submit_write) {
+            dest[0] = MP_OBJ_FROM_PTR(&SDObject_submit_write_obj);
+            dest[1] = self;  
+        }
+        else if (attr == MP_QSTR_submit_sync) {
+            dest[0] = MP_OBJ_FROM_PTR(&SDObject_submit_sync_obj);
+            dest[1] = self;  
+        }
+        else if (attr == MP_QSTR_poll) {
+            dest[0] = MP_OBJ_FROM_PTR(&SDObject_poll_obj);
+            dest[1] = self;  
+        }
+        else if (attr == MP_QSTR___del__) {
+            dest[0] = MP_OBJ_FROM_PTR(&SDObject_del_obj);
+            dest[1] = self;  
+        }
+        else if (attr == MP_QSTR_baudrate)
+            dest[0] = mp_obj_new_int_from_uint(self->baudrate);
+        else if (attr == MP_QSTR_dma)
+            dest[0] = mp_obj_new_bool(self->dma_rx > -1);
+        else if (attr == MP_QSTR_tran_speed)
+            dest[0] = mp_obj_new_int_from_uint(self->tran_speed);
+        else if (attr == MP_QSTR_high_speed)
+            dest[0] = mp_obj_new_bool(self->hs);
+        else if (attr == MP_QSTR_cmd23)
+            dest[0] = mp_obj_new_bool(self->cmd23);
+        else if (attr == MP_QSTR_worker)
+            dest[0] = mp_obj_new_bool(self->worker != NULL);
         //  return;
     } 
+    else if (dest[0] == MP_OBJ_SENTINEL && dest[1] != MP_OBJ_NULL) {
+        //store ~ CMD23 can only be switched on for cards that advertise it
+        if (attr == MP_QSTR_cmd23) {
+            self->cmd23 = self->scr_cmd23 && mp_obj_is_true(dest[1]);
+            dest[0] = MP_OBJ_NULL;
+        }
+    }
 }
 
 const mp_obj_type_t sdcard_SDObject_type = {
@@ -497,6 +3806,14 @@ typedef struct _sdcard_SDCard_obj_t {
     mp_obj_t      cs;
     mp_obj_t      baud;
     mp_obj_t      led;
+    mp_obj_t      dma;
+    mp_obj_t      cache;
+    mp_obj_t      prefetch;
+    mp_obj_t      pin;
+    mp_obj_t      coalesce;
+    mp_obj_t      crc;
+    mp_obj_t      worker;
+    mp_obj_t      trace;
     bool          conn;
     bool          mounted;
     int8_t        detect;
@@ -521,6 +3838,8 @@ STATIC mp_obj_t SDCard_mount(mp_obj_t self_in) {
     mp_obj_t mnt_args[2];
     mnt_args[0] = self->sdobject;
     mnt_args[1] = d;
+    if (self->sdobject->use_worker && self->sdobject->worker == NULL) sdcard_worker_start(self->sdobject);
+    sdcard_pin_fat(self->sdobject);
     mp_vfs_mount(2, mnt_args, (mp_map_t *)&mp_const_empty_map);
     mp_obj_list_append(mp_sys_path, d);
     mp_printf(MP_PYTHON_PRINTER, "%s Mounted\n", self->drive);
@@ -535,6 +3854,8 @@ STATIC mp_obj_t SDCard_eject(mp_obj_t self_in) {
     sdcard_SDCard_obj_t *self = MP_OBJ_TO_PTR(self_in);
     mp_obj_t d  = mp_obj_new_str(self->drive, strlen(self->drive));
     mp_vfs_umount(d);
+    sdcard_io_sync(self->sdobject);     //the VFS is gone ~ anything it left in the cache goes to the card now
+    sdcard_worker_stop(self->sdobject);
     mp_obj_list_remove(mp_sys_path, d);
     mp_printf(MP_PYTHON_PRINTER, "%s Ejected\n", self->drive);
     self->mounted = false;
@@ -551,6 +3872,39 @@ STATIC bool sdcard_waiting(sdcard_SDCard_obj_t *self, bool wait) {
 }
 
 //__> SETUP ____________________________________________________________
+//connects to a seated card ~ false means there was none to connect to
+STATIC bool sdcard_connect(sdcard_SDCard_obj_t *self, bool automount) {
+    if (self->detect > -1 && !gpio_get(self->detect)) {
+        mp_printf(MP_PYTHON_PRINTER, "No SD Card Detected\n");
+        return false;
+    }
+    
+    gpio_set_function(self->sck , GPIO_FUNC_SPI);
+    gpio_set_function(self->mosi, GPIO_FUNC_SPI);
+    gpio_set_function(self->miso, GPIO_FUNC_SPI);
+    
+    mp_obj_t sdo_args[14];
+    sdo_args[0]    = self->spi;
+    sdo_args[1]    = self->cs;
+    sdo_args[2]    = self->baud;
+    sdo_args[3]    = self->led;
+    sdo_args[4]    = self->dma;
+    sdo_args[5]    = self->cache;
+    sdo_args[6]    = MP_OBJ_NEW_SMALL_INT(4);
+    sdo_args[7]    = self->prefetch;
+    sdo_args[8]    = self->pin;
+    sdo_args[9]    = self->coalesce;
+    sdo_args[10]   = MP_OBJ_NEW_SMALL_INT(100);
+    sdo_args[11]   = self->crc;
+    sdo_args[12]   = self->worker;
+    sdo_args[13]   = self->trace;
+    self->sdobject = MP_OBJ_TO_PTR(SDObject_make_new(NULL, 14, 0, sdo_args));
+    self->conn     = true;
+    
+    if (automount) SDCard_mount(self);
+    return true;
+}
+
 STATIC mp_obj_t SDCard_setup(mp_uint_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     enum {ARG_self, ARG_automount, ARG_wait};
     static const mp_arg_t allowed_args[] = {
@@ -570,22 +3924,7 @@ STATIC mp_obj_t SDCard_setup(mp_uint_t n_args, const mp_obj_t *args, mp_map_t *k
             sleep_ms(500);
         
         sleep_ms(300);  //an extra little wait to make sure the sdcard is fully seated before connecting
-        if ((self->detect == -1 || (self->detect > -1 && gpio_get(self->detect))) && !self->conn) {
-            gpio_set_function(self->sck , GPIO_FUNC_SPI);
-            gpio_set_function(self->mosi, GPIO_FUNC_SPI);
-            gpio_set_function(self->miso, GPIO_FUNC_SPI);
-        
-            mp_obj_t sdo_args[4];
-            sdo_args[0]    = self->spi;
-            sdo_args[1]    = self->cs;
-            sdo_args[2]    = self->baud;
-            sdo_args[3]    = self->led;
-            self->sdobject = MP_OBJ_TO_PTR(SDObject_make_new(NULL, 4, 0, sdo_args));
-            self->conn     = true;
-        
-            if (kw[ARG_automount].u_bool) SDCard_mount(self);
-            
-        } else mp_printf(MP_PYTHON_PRINTER, "No SD Card Detected\n");
+        sdcard_connect(self, kw[ARG_automount].u_bool);
     }
         
     return mp_const_none;
@@ -593,25 +3932,99 @@ STATIC mp_obj_t SDCard_setup(mp_uint_t n_args, const mp_obj_t *args, mp_map_t *k
 
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(SDCard_setup_obj, 0, SDCard_setup);
 
+//__> ADETECT __________________________________________________________
+//setup(wait=True) for uasyncio ~ the detect pin is checked every `interval` ms and the seating wait is slept through too
+const mp_obj_type_t sdcard_SDDetect_type;
+
+typedef struct _sdcard_SDDetect_obj_t {
+    mp_obj_base_t base;
+    sdcard_SDCard_obj_t *card;
+    bool      automount;
+    bool      seated;       //the card showed up and the seating wait has been slept
+    mp_int_t  interval;
+    mp_obj_t  sleep;        //uasyncio.sleep_ms
+} sdcard_SDDetect_obj_t;
+
+STATIC mp_obj_t SDDetect_iternext(mp_obj_t self_in) {
+    sdcard_SDDetect_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    sdcard_SDCard_obj_t   *card = self->card;
+    if (card->conn) return MP_OBJ_STOP_ITERATION;
+    
+    if (self->seated) {
+        self->seated = false;
+        sdcard_connect(card, self->automount);
+        return MP_OBJ_STOP_ITERATION;
+    }
+    
+    mp_int_t ms = self->interval;
+    if (!sdcard_waiting(card, true)) {
+        self->seated = true;
+        ms = 300;
+    }
+    
+    mp_iternext(mp_call_function_1(self->sleep, MP_OBJ_NEW_SMALL_INT(ms)));
+    return mp_const_none;
+}
+
+const mp_obj_type_t sdcard_SDDetect_type = {
+    { &mp_type_type },
+    .name        = MP_QSTR_SDDetect,
+    .getiter     = mp_identity_getiter,
+    .iternext    = SDDetect_iternext,
+};
+
+STATIC mp_obj_t SDCard_adetect(mp_uint_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    enum {ARG_self, ARG_automount, ARG_interval};
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_self      , MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj  = MP_ROM_NONE}},
+        { MP_QSTR_automount , MP_ARG_BOOL                 , {.u_bool = true       }},
+        { MP_QSTR_interval  , MP_ARG_INT                  , {.u_int  = 500        }},
+    };
+    
+    mp_arg_val_t kw[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, kw);
+    
+    mp_obj_t uasyncio = mp_import_name(MP_QSTR_uasyncio, mp_const_none, MP_OBJ_NEW_SMALL_INT(0));
+    
+    sdcard_SDDetect_obj_t *self = m_new_obj(sdcard_SDDetect_obj_t);
+    self->base.type = &sdcard_SDDetect_type;
+    self->card      = MP_OBJ_TO_PTR(kw[ARG_self].u_obj);
+    self->automount = kw[ARG_automount].u_bool;
+    self->seated    = false;
+    self->interval  = (kw[ARG_interval].u_int > 0) ? kw[ARG_interval].u_int : 1;
+    self->sleep     = mp_load_attr(uasyncio, MP_QSTR_sleep_ms);
+    return MP_OBJ_FROM_PTR(self);
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(SDCard_adetect_obj, 0, SDCard_adetect);
+
 //__> INIT ______________________________________________________________
 STATIC mp_obj_t SDCard_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
-    mp_arg_check_num(n_args, n_kw, 0, 11, true);
+    mp_arg_check_num(n_args, n_kw, 0, 19, true);
     sdcard_SDCard_obj_t *self = m_new_obj(sdcard_SDCard_obj_t);
     self->base.type = &sdcard_SDCard_type;
     
-    enum {ARG_spi, ARG_sck, ARG_mosi, ARG_miso, ARG_cs, ARG_baudrate, ARG_automount, ARG_drive, ARG_led, ARG_detect, ARG_wait};
+    enum {ARG_spi, ARG_sck, ARG_mosi, ARG_miso, ARG_cs, ARG_baudrate, ARG_automount, ARG_drive, ARG_led, ARG_detect, ARG_wait, ARG_dma, ARG_cache, ARG_prefetch, ARG_pin, ARG_coalesce, ARG_crc, ARG_worker, ARG_trace};
     static const mp_arg_t allowed_args[] = {
         { MP_QSTR_spi       , MP_ARG_REQUIRED | MP_ARG_INT , {.u_int     = 0                            }},
         { MP_QSTR_sck       , MP_ARG_REQUIRED | MP_ARG_INT , {.u_int     = 0                            }},
         { MP_QSTR_mosi      , MP_ARG_REQUIRED | MP_ARG_INT , {.u_int     = 0                            }},
         { MP_QSTR_miso      , MP_ARG_REQUIRED | MP_ARG_INT , {.u_int     = 0                            }},
         { MP_QSTR_cs        , MP_ARG_REQUIRED | MP_ARG_INT , {.u_int     = 0                            }},
-        { MP_QSTR_baudrate  , MP_ARG_INT                   , {.u_int     = 0x500000                     }},
+        { MP_QSTR_baudrate  , MP_ARG_OBJ                   , {.u_obj     = MP_OBJ_NULL                  }}, //int or 'auto'
         { MP_QSTR_automount , MP_ARG_BOOL                  , {.u_bool    = true                         }},
         { MP_QSTR_drive     , MP_ARG_OBJ                   , {.u_obj     = MP_OBJ_NEW_QSTR(MP_QSTR_nul) }},
         { MP_QSTR_led       , MP_ARG_INT                   , {.u_int     = -1                           }},
         { MP_QSTR_detect    , MP_ARG_INT                   , {.u_int     = -1                           }},
         { MP_QSTR_wait      , MP_ARG_BOOL                  , {.u_bool    = false                        }},
+        { MP_QSTR_dma       , MP_ARG_BOOL                  , {.u_bool    = false                        }},
+        { MP_QSTR_cache     , MP_ARG_INT                   , {.u_int     = 0                            }},
+        { MP_QSTR_prefetch  , MP_ARG_INT                   , {.u_int     = 0                            }},
+        { MP_QSTR_pin       , MP_ARG_INT                   , {.u_int     = 0                            }},
+        { MP_QSTR_coalesce  , MP_ARG_INT                   , {.u_int     = 0                            }},
+        { MP_QSTR_crc       , MP_ARG_BOOL                  , {.u_bool    = false                        }},
+        { MP_QSTR_worker    , MP_ARG_BOOL                  , {.u_bool    = false                        }},
+        { MP_QSTR_trace     , MP_ARG_INT                   , {.u_int     = 0                            }},
     };
     
     mp_arg_val_t kw[MP_ARRAY_SIZE(allowed_args)];
@@ -623,8 +4036,16 @@ STATIC mp_obj_t SDCard_make_new(const mp_obj_type_t *type, size_t n_args, size_t
     self->detect    = kw[ARG_detect].u_int;
     self->spi       = mp_obj_new_int(kw[ARG_spi].u_int);
     self->cs        = mp_obj_new_int(kw[ARG_cs].u_int);
-    self->baud      = mp_obj_new_int(kw[ARG_baudrate].u_int);
+    self->baud      = (kw[ARG_baudrate].u_obj == MP_OBJ_NULL)? MP_OBJ_NEW_SMALL_INT(BAUD_DEFAULT) : kw[ARG_baudrate].u_obj;
     self->led       = mp_obj_new_int(kw[ARG_led].u_int);
+    self->dma       = mp_obj_new_bool(kw[ARG_dma].u_bool);
+    self->cache     = mp_obj_new_int(kw[ARG_cache].u_int);
+    self->prefetch  = mp_obj_new_int(kw[ARG_prefetch].u_int);
+    self->pin       = mp_obj_new_int(kw[ARG_pin].u_int);
+    self->coalesce  = mp_obj_new_int(kw[ARG_coalesce].u_int);
+    self->crc       = mp_obj_new_bool(kw[ARG_crc].u_bool);
+    self->worker    = mp_obj_new_bool(kw[ARG_worker].u_bool);
+    self->trace     = mp_obj_new_int(kw[ARG_trace].u_int);
     self->conn      = false;
     self->mounted   = false;
     
@@ -688,6 +4109,14 @@ STATIC void SDCard_attr(mp_obj_t self_in, qstr attr, mp_obj_t *dest) {
             dest[0] = MP_OBJ_FROM_PTR(&SDCard_setup_obj);
             dest[1] = self;  
         }
+        else if (attr == MP_QSTR_adetect) {
+            dest[0] = MP_OBJ_FROM_PTR(&SDCard_adetect_obj);
+            dest[1] = self;  
+        }
+        else if (attr == MP_QSTR_areadblocks || attr == MP_QSTR_awriteblocks || attr == MP_QSTR_stats || attr == MP_QSTR_trace || attr == MP_QSTR_bus_info || attr == MP_QSTR_readv || attr == MP_QSTR_writev || attr == MP_QSTR_logger) {
+            if (ready) SDObject_attr(self->sdobject, attr, dest);
+            else mp_printf(MP_PYTHON_PRINTER, "SD Card not inserted or not initialized");
+        }
     }
 }
 
@@ -701,10 +4130,20 @@ const mp_obj_type_t sdcard_SDCard_type = {
 };
 
 //__> MODULE __________________________________________________________________________
+#if SDCARD_HOST
+//simulated card ~ sdcard_host.c
+MP_DECLARE_CONST_FUN_OBJ_KW(sdcard_sim_obj);
+MP_DECLARE_CONST_FUN_OBJ_KW(sdcard_sim_info_obj);
+#endif
+
 STATIC const mp_map_elem_t sdcard_globals_table[] = {
     { MP_OBJ_NEW_QSTR(MP_QSTR___name__) , MP_OBJ_NEW_QSTR(MP_QSTR_sdcard) },
     { MP_OBJ_NEW_QSTR(MP_QSTR_SDObject) , (mp_obj_t)&sdcard_SDObject_type },
     { MP_OBJ_NEW_QSTR(MP_QSTR_SDCard)   , (mp_obj_t)&sdcard_SDCard_type   },
+#if SDCARD_HOST
+    { MP_OBJ_NEW_QSTR(MP_QSTR_sim)      , (mp_obj_t)&sdcard_sim_obj       },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_sim_info) , (mp_obj_t)&sdcard_sim_info_obj  },
+#endif
 };
 
 STATIC MP_DEFINE_CONST_DICT (mp_module_sdcard_globals, sdcard_globals_table);
@@ -0,0 +1,89 @@
+#ifndef SDCARD_HAL_H
+#define SDCARD_HAL_H
+
+//the slice of the Pico SDK the driver uses ~ SDCARD_HOST swaps it for sdcard_host.c and a simulated card
+//SDCARD_HAL_DMA says whether DMA channels and the sniffer exist
+//SDCARD_HAL_PARK says whether code can run on core1 while core0 writes flash
+
+#if SDCARD_HOST
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define SDCARD_HAL_DMA  (0)
+#define SDCARD_HAL_PARK (1)
+
+//__> SPI _____________________________________________________________________________________
+typedef struct spi_inst spi_inst_t;
+extern spi_inst_t sdcard_host_spi0, sdcard_host_spi1;
+
+#define spi0            (&sdcard_host_spi0)
+#define spi1            (&sdcard_host_spi1)
+
+uint32_t spi_init(spi_inst_t *spi, uint32_t baudrate);
+uint32_t spi_set_baudrate(spi_inst_t *spi, uint32_t baudrate);
+uint32_t spi_get_baudrate(const spi_inst_t *spi);
+void     spi_set_format(spi_inst_t *spi, uint32_t data_bits, int cpol, int cpha, int order);
+int      spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len);
+int      spi_read_blocking(spi_inst_t *spi, uint8_t repeated_tx_data, uint8_t *dst, size_t len);
+
+//__> GPIO _____________________________________________________________________________________
+#define GPIO_FUNC_SPI   (1)
+#define GPIO_FUNC_SIO   (5)
+#define GPIO_IN         (false)
+#define GPIO_OUT        (true)
+
+void gpio_set_function(uint32_t gpio, uint32_t fn);
+void gpio_set_dir(uint32_t gpio, bool out);
+void gpio_set_pulls(uint32_t gpio, bool up, bool down);
+void gpio_put(uint32_t gpio, bool value);
+bool gpio_get(uint32_t gpio);
+
+//__> TIME _____________________________________________________________________________________
+typedef int32_t alarm_id_t;
+typedef int64_t (*alarm_callback_t)(alarm_id_t id, void *user_data);
+
+uint64_t   time_us_64(void);
+void       sleep_us(uint64_t us);
+void       sleep_ms(uint32_t ms);
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data, bool fire_if_past);
+bool       cancel_alarm(alarm_id_t alarm_id);
+
+//__> CLOCKS _____________________________________________________________________________________
+#define clk_peri        (6)
+
+uint32_t clock_get_hz(int clk_index);
+
+//__> MULTICORE _____________________________________________________________________________________
+void multicore_reset_core1(void);
+void multicore_launch_core1(void (*entry)(void));
+uint32_t get_core_num(void);
+
+static inline void __dmb(void)               { __sync_synchronize(); }
+static inline void __sev(void)               { }
+static inline void tight_loop_contents(void) { }
+void __wfe(void);
+
+#else
+
+#include "pico/time.h"
+#include "hardware/spi.h"
+#include "hardware/gpio.h"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
+#include "pico/multicore.h"
+#include "pico/version.h"
+
+#define SDCARD_HAL_DMA  (1)
+
+//core1 runs from flash ~ the port has to park it around flash writes, which MicroPython does from v1.22 on SDK 1.2 or later
+//a port that parks core1 itself can define it as 1
+#ifndef SDCARD_HAL_PARK
+#define SDCARD_HAL_PARK ((PICO_SDK_VERSION_MAJOR > 1 || PICO_SDK_VERSION_MINOR >= 2) && MICROPY_VERSION >= 0x011600)
+#endif
+
+#endif
+
+#endif
@@ -0,0 +1,335 @@
+#include "py/runtime.h"
+#include "py/obj.h"
+#include "sdcard_hal.h"
+#include "sdcard_sim.h"
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+
+//the Pico SDK calls sdcard.c makes, answered on the host ~ SPI traffic goes to a simulated card
+//time is virtual: it only moves with clocked bytes and sleeps, so runs are repeatable and don't wait on the host
+#if SDCARD_HOST
+
+#define HOST_PERI_HZ    (125000000)
+#define HOST_GPIOS      (30)
+#define HOST_ALARMS     (8)
+#define HOST_CARDS      (4)         //simulated cards one bus can carry
+
+typedef struct {
+    uint32_t     cs;
+    sdcard_sim_t sim;
+} host_card_t;
+
+struct spi_inst {
+    uint32_t     baudrate;
+    uint8_t      cards;         //with none on the bus MISO floats high
+    host_card_t  card[HOST_CARDS];
+    uint32_t     collisions;    //bytes clocked while more than one card was selected
+};
+
+spi_inst_t sdcard_host_spi0, sdcard_host_spi1;
+STATIC spi_inst_t *const host_spis[2] = {&sdcard_host_spi0, &sdcard_host_spi1};
+
+STATIC uint64_t host_ns;                                        //virtual clock
+STATIC bool     host_gpio[HOST_GPIOS] = {[0 ... HOST_GPIOS - 1] = true};
+STATIC __thread uint32_t host_core;
+
+
+//__> TIME _____________________________________________________________________________________
+typedef struct {
+    alarm_id_t       id;    //0 marks a free slot
+    uint64_t         at;
+    alarm_callback_t callback;
+    void            *user_data;
+} host_alarm_t;
+
+STATIC host_alarm_t host_alarms[HOST_ALARMS];
+STATIC alarm_id_t   host_alarm_next = 1;
+
+//alarms belong to core0 ~ they fire whenever it looks at the clock
+STATIC void host_alarm_poll(void) {
+    if (host_core != 0) return;
+
+    uint64_t now = __atomic_load_n(&host_ns, __ATOMIC_RELAXED) / 1000;
+    for (int i = 0; i < HOST_ALARMS; i++) {
+        host_alarm_t *a = &host_alarms[i];
+        if (!a->id || a->at > now) continue;
+
+        alarm_id_t id = a->id;
+        a->id = 0;
+        int64_t again = a->callback(id, a->user_data);
+        if (again) {
+            a->id = id;
+            a->at = now + ((again > 0) ? again : -again);
+        }
+    }
+}
+
+STATIC uint64_t host_advance(uint64_t ns) {
+    return __atomic_add_fetch(&host_ns, ns, __ATOMIC_RELAXED);
+}
+
+uint64_t time_us_64(void) {
+    host_alarm_poll();
+    return __atomic_load_n(&host_ns, __ATOMIC_RELAXED) / 1000;
+}
+
+void sleep_us(uint64_t us) {
+    host_advance(us * 1000);
+    host_alarm_poll();
+}
+
+void sleep_ms(uint32_t ms) {
+    sleep_us((uint64_t)ms * 1000);
+}
+
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+    (void)fire_if_past;
+    for (int i = 0; i < HOST_ALARMS; i++) {
+        host_alarm_t *a = &host_alarms[i];
+        if (a->id) continue;
+
+        a->id        = host_alarm_next++;
+        a->at        = time_us_64() + ((uint64_t)ms * 1000);
+        a->callback  = callback;
+        a->user_data = user_data;
+        if (host_alarm_next <= 0) host_alarm_next = 1;
+        return a->id;
+    }
+    return -1;
+}
+
+bool cancel_alarm(alarm_id_t alarm_id) {
+    for (int i = 0; i < HOST_ALARMS; i++) {
+        if (host_alarms[i].id != alarm_id) continue;
+        host_alarms[i].id = 0;
+        return true;
+    }
+    return false;
+}
+
+uint32_t clock_get_hz(int clk_index) {
+    (void)clk_index;
+    return HOST_PERI_HZ;
+}
+
+
+//__> SPI _____________________________________________________________________________________
+//same prescale/postdiv search as the SDK ~ callers see the rates the real SSP would give them
+uint32_t spi_set_baudrate(spi_inst_t *spi, uint32_t baudrate) {
+    uint32_t prescale, postdiv;
+
+    for (prescale = 2; prescale <= 254; prescale += 2)
+        if (HOST_PERI_HZ < (prescale + 2) * 256 * (uint64_t)baudrate) break;
+
+    for (postdiv = 256; postdiv > 1; --postdiv)
+        if (HOST_PERI_HZ / (prescale * (postdiv - 1)) > baudrate) break;
+
+    spi->baudrate = HOST_PERI_HZ / (prescale * postdiv);
+    return spi->baudrate;
+}
+
+uint32_t spi_get_baudrate(const spi_inst_t *spi) {
+    return spi->baudrate;
+}
+
+uint32_t spi_init(spi_inst_t *spi, uint32_t baudrate) {
+    return spi_set_baudrate(spi, baudrate);
+}
+
+void spi_set_format(spi_inst_t *spi, uint32_t data_bits, int cpol, int cpha, int order) {
+    (void)spi; (void)data_bits; (void)cpol; (void)cpha; (void)order;
+}
+
+//one byte each way ~ the clock moves by the time 8 bits take at the current rate
+//every selected card drives MISO, so two at once garble each other the way a real bus would
+STATIC uint8_t host_spi_xfer(spi_inst_t *spi, uint8_t tx) {
+    uint64_t now = host_advance(8000000000ull / spi->baudrate);
+    uint8_t  rx  = 0xFF;
+    uint8_t  selected = 0;
+
+    for (uint8_t i = 0; i < spi->cards; i++) {
+        if (!spi->card[i].sim.selected) continue;
+        rx &= sdcard_sim_xfer(&spi->card[i].sim, tx, now, spi->baudrate);
+        selected++;
+    }
+
+    if (selected > 1) spi->collisions++;
+    return rx;
+}
+
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len) {
+    for (size_t i = 0; i < len; i++) host_spi_xfer(spi, src[i]);
+    return len;
+}
+
+int spi_read_blocking(spi_inst_t *spi, uint8_t repeated_tx_data, uint8_t *dst, size_t len) {
+    for (size_t i = 0; i < len; i++) dst[i] = host_spi_xfer(spi, repeated_tx_data);
+    return len;
+}
+
+
+//__> GPIO _____________________________________________________________________________________
+void gpio_set_function(uint32_t gpio, uint32_t fn) {
+    (void)gpio; (void)fn;
+}
+
+void gpio_set_dir(uint32_t gpio, bool out) {
+    (void)gpio; (void)out;
+}
+
+void gpio_set_pulls(uint32_t gpio, bool up, bool down) {
+    (void)gpio; (void)up; (void)down;
+}
+
+//a card's chip-select follows its pin
+void gpio_put(uint32_t gpio, bool value) {
+    if (gpio >= HOST_GPIOS) return;
+    host_gpio[gpio] = value;
+
+    for (int i = 0; i < 2; i++)
+        for (uint8_t j = 0; j < host_spis[i]->cards; j++)
+            if (host_spis[i]->card[j].cs == gpio) sdcard_sim_select(&host_spis[i]->card[j].sim, !value);
+}
+
+//inputs read high ~ a card detect switch always reports a card
+bool gpio_get(uint32_t gpio) {
+    return (gpio < HOST_GPIOS) ? host_gpio[gpio] : true;
+}
+
+
+//__> MULTICORE _____________________________________________________________________________________
+//core1 is a thread ~ reset waits for it to leave its entry function, which is all the driver ever asks of it
+STATIC pthread_t host_core1;
+STATIC bool      host_core1_running = false;
+STATIC void    (*host_core1_entry)(void);
+
+STATIC void *host_core1_main(void *arg) {
+    (void)arg;
+    host_core = 1;
+    host_core1_entry();
+    return NULL;
+}
+
+void multicore_reset_core1(void) {
+    if (!host_core1_running) return;
+    pthread_join(host_core1, NULL);
+    host_core1_running = false;
+}
+
+void multicore_launch_core1(void (*entry)(void)) {
+    host_core1_entry   = entry;
+    host_core1_running = (pthread_create(&host_core1, NULL, host_core1_main, NULL) == 0);
+}
+
+uint32_t get_core_num(void) {
+    return host_core;
+}
+
+void __wfe(void) {
+    sched_yield();
+}
+
+
+//__> SIMULATOR _____________________________________________________________________________________
+//cards are told apart by chip-select ~ NULL when there is none on `cs`
+STATIC host_card_t *host_card(spi_inst_t *spi, mp_int_t cs) {
+    for (uint8_t i = 0; i < spi->cards; i++)
+        if (cs < 0 || spi->card[i].cs == (uint32_t)cs) return &spi->card[i];
+    return NULL;
+}
+
+//sdcard.sim(spi, cs, image=None, mb=64, token_us=100, busy_us=250, block_us=50, max_hz=0, cmd23=True) ~ puts a card on a bus, replacing the one on `cs`
+STATIC mp_obj_t sdcard_sim(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum {ARG_spi, ARG_cs, ARG_image, ARG_mb, ARG_token_us, ARG_busy_us, ARG_block_us, ARG_max_hz, ARG_cmd23};
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_spi       , MP_ARG_REQUIRED | MP_ARG_INT , {.u_int     = 0       }},
+        { MP_QSTR_cs        , MP_ARG_REQUIRED | MP_ARG_INT , {.u_int     = 0       }},
+        { MP_QSTR_image     , MP_ARG_OBJ                   , {.u_obj     = mp_const_none}}, //file path ~ None keeps the card in memory
+        { MP_QSTR_mb        , MP_ARG_INT                   , {.u_int     = 64      }},
+        { MP_QSTR_token_us  , MP_ARG_INT                   , {.u_int     = 100     }},
+        { MP_QSTR_busy_us   , MP_ARG_INT                   , {.u_int     = 250     }},
+        { MP_QSTR_block_us  , MP_ARG_INT                   , {.u_int     = 50      }},
+        { MP_QSTR_max_hz    , MP_ARG_INT                   , {.u_int     = 0       }},
+        { MP_QSTR_cmd23     , MP_ARG_BOOL                  , {.u_bool    = true    }},
+    };
+
+    mp_arg_val_t kw[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, kw);
+
+    if (kw[ARG_mb].u_int < 1 || kw[ARG_cs].u_int < 0 || kw[ARG_cs].u_int >= HOST_GPIOS)
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid Argument"));
+
+    spi_inst_t  *spi  = host_spis[kw[ARG_spi].u_int ? 1 : 0];
+    host_card_t *card = host_card(spi, kw[ARG_cs].u_int);
+    if (card == NULL) {
+        if (spi->cards == HOST_CARDS) mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Bus Full"));
+        card = &spi->card[spi->cards];
+    } else {
+        //the slot is taken over by the last card so a failed init leaves no hole
+        sdcard_sim_deinit(&card->sim);
+        *card = spi->card[--spi->cards];
+        card  = &spi->card[spi->cards];
+    }
+
+    const char *image = (kw[ARG_image].u_obj == mp_const_none) ? NULL : mp_obj_str_get_str(kw[ARG_image].u_obj);
+    if (!sdcard_sim_init(&card->sim, image, kw[ARG_mb].u_int)) mp_raise_OSError(errno);
+
+    card->sim.token_ns = (uint64_t)kw[ARG_token_us].u_int * 1000;
+    card->sim.busy_ns  = (uint64_t)kw[ARG_busy_us].u_int  * 1000;
+    card->sim.block_ns = (uint64_t)kw[ARG_block_us].u_int * 1000;
+    card->sim.max_hz   = kw[ARG_max_hz].u_int;
+    card->sim.cmd23    = kw[ARG_cmd23].u_bool;
+
+    card->cs = kw[ARG_cs].u_int;
+    spi->cards++;
+    sdcard_sim_select(&card->sim, !host_gpio[card->cs]);
+
+    return mp_const_none;
+}
+
+MP_DEFINE_CONST_FUN_OBJ_KW(sdcard_sim_obj, 2, sdcard_sim);
+
+//sdcard.sim_info(spi, reset=False, cs=-1) ~ bus and protocol counters of a simulated card, the first one on the bus by default
+STATIC mp_obj_t sdcard_sim_info(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum {ARG_spi, ARG_reset, ARG_cs};
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_spi       , MP_ARG_REQUIRED | MP_ARG_INT , {.u_int     = 0       }},
+        { MP_QSTR_reset     , MP_ARG_BOOL                  , {.u_bool    = false   }},
+        { MP_QSTR_cs        , MP_ARG_INT                   , {.u_int     = -1      }},
+    };
+
+    mp_arg_val_t kw[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, kw);
+
+    spi_inst_t  *spi  = host_spis[kw[ARG_spi].u_int ? 1 : 0];
+    host_card_t *card = host_card(spi, kw[ARG_cs].u_int);
+    if (card == NULL) mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("No Card"));
+    sdcard_sim_t *sim = &card->sim;
+
+    //commands by index ~ an ACMD counts under its own number
+    mp_obj_t cmds = mp_obj_new_dict(0);
+    for (int i = 0; i < 64; i++)
+        if (sim->cmds[i]) mp_obj_dict_store(cmds, MP_OBJ_NEW_SMALL_INT(i), mp_obj_new_int_from_uint(sim->cmds[i]));
+
+    mp_obj_t info = mp_obj_new_dict(0);
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_bytes)      , mp_obj_new_int_from_ull(sim->bytes));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_commands)   , cmds);
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_stop_tran)  , mp_obj_new_int_from_uint(sim->stop_tran));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_read)       , mp_obj_new_int_from_uint(sim->blocks_read));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_written)    , mp_obj_new_int_from_uint(sim->blocks_written));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_crc_rejects), mp_obj_new_int_from_uint(sim->crc_rejects));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_baudrate)   , mp_obj_new_int_from_uint(spi->baudrate));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_collisions) , mp_obj_new_int_from_uint(spi->collisions));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_time_us)    , mp_obj_new_int_from_ull(time_us_64()));
+
+    if (kw[ARG_reset].u_bool) {
+        sdcard_sim_reset_counters(sim);
+        spi->collisions = 0;
+    }
+    return info;
+}
+
+MP_DEFINE_CONST_FUN_OBJ_KW(sdcard_sim_info_obj, 1, sdcard_sim_info);
+
+#endif
@@ -0,0 +1,427 @@
+#include "sdcard_sim.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+//this file only builds into the host port ~ it has no MicroPython or SDK dependency
+#if SDCARD_HOST
+
+#define R1_IDLE         (0x01)
+#define R1_ILLEGAL      (0x04)
+#define R1_CRC          (0x08)
+#define R1_ADDR         (0x20)
+#define R1_PARAM        (0x40)
+
+#define RESP_ACCEPTED   (0xE5)
+#define RESP_CRC_ERROR  (0xEB)
+#define RESP_WR_ERROR   (0xED)
+
+#define TOKEN_CMD25     (0xFC)
+#define TOKEN_STOP_TRAN (0xFD)
+#define TOKEN_DATA      (0xFE)
+#define TOKEN_RANGE     (0x08)  //data error token ~ out of range
+
+#define SIM_AU_SIZE     (0x9)   //4 MB allocation unit
+#define SIM_TRAN_SPEED  (0x32)  //25 MHz
+
+
+//__> CRC _____________________________________________________________________________________
+static uint8_t sim_crc7(const uint8_t *buf, int len) {
+    uint8_t crc = 0;
+    for (int i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int b = 0; b < 8; b++)
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x12 : (crc << 1);
+    }
+    return crc >> 1;
+}
+
+static uint16_t sim_crc16(const uint8_t *buf, int len) {
+    uint16_t crc = 0;
+    for (int i = 0; i < len; i++) {
+        crc ^= buf[i] << 8;
+        for (int b = 0; b < 8; b++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+    }
+    return crc;
+}
+
+
+//__> STORE _____________________________________________________________________________________
+static void sim_load(sdcard_sim_t *sim, uint32_t block, uint8_t *dst) {
+    if (sim->mem) {
+        memcpy(dst, sim->mem + ((size_t)block * SIM_BLOCK), SIM_BLOCK);
+        return;
+    }
+
+    //past the end of a short image reads as erased
+    size_t got = 0;
+    if (fseeko(sim->file, (off_t)block * SIM_BLOCK, SEEK_SET) == 0) got = fread(dst, 1, SIM_BLOCK, sim->file);
+    memset(dst + got, 0xFF, SIM_BLOCK - got);
+}
+
+static void sim_store(sdcard_sim_t *sim, uint32_t block, const uint8_t *src) {
+    if (sim->mem) {
+        memcpy(sim->mem + ((size_t)block * SIM_BLOCK), src, SIM_BLOCK);
+        return;
+    }
+
+    if (fseeko(sim->file, (off_t)block * SIM_BLOCK, SEEK_SET) == 0) fwrite(src, 1, SIM_BLOCK, sim->file);
+}
+
+bool sdcard_sim_init(sdcard_sim_t *sim, const char *image, uint32_t mb) {
+    memset(sim, 0, sizeof(*sim));
+    sim->blocks = mb * 2048;
+    sim->idle   = true;
+
+    if (image == NULL) {
+        sim->mem = calloc(sim->blocks, SIM_BLOCK);
+        return sim->mem != NULL;
+    }
+
+    //an existing image keeps its contents ~ a new one is grown to the card size
+    sim->file = fopen(image, "r+b");
+    if (sim->file == NULL) sim->file = fopen(image, "w+b");
+    if (sim->file == NULL) return false;
+
+    off_t size = (off_t)sim->blocks * SIM_BLOCK;
+    fseeko(sim->file, 0, SEEK_END);
+    if (ftello(sim->file) < size) {
+        fseeko(sim->file, size - 1, SEEK_SET);
+        fputc(0, sim->file);
+    }
+    return true;
+}
+
+void sdcard_sim_deinit(sdcard_sim_t *sim) {
+    if (sim->file) fclose(sim->file);
+    free(sim->mem);
+    sim->file = NULL;
+    sim->mem  = NULL;
+}
+
+void sdcard_sim_select(sdcard_sim_t *sim, bool selected) {
+    if (!selected) sim->framed = 0;
+    sim->selected = selected;
+}
+
+void sdcard_sim_reset_counters(sdcard_sim_t *sim) {
+    sim->bytes = 0;
+    memset(sim->cmds, 0, sizeof(sim->cmds));
+    sim->stop_tran      = 0;
+    sim->blocks_read    = 0;
+    sim->blocks_written = 0;
+    sim->crc_rejects    = 0;
+}
+
+
+//__> REGISTERS _____________________________________________________________________________________
+//CSD v2 ~ SDHC with a C_SIZE that matches the image, no class 10 so high speed is never offered
+static void sim_csd(sdcard_sim_t *sim, uint8_t *csd) {
+    uint32_t c_size = (sim->blocks / 1024) - 1;
+    const uint8_t base[15] = {
+        0x40, 0x0E, 0x00, SIM_TRAN_SPEED, 0x1B, 0x59, 0x00,
+        (c_size >> 16) & 0x3F, (c_size >> 8) & 0xFF, c_size & 0xFF,
+        0x7F, 0x80, 0x0A, 0x40, 0x00
+    };
+    memcpy(csd, base, 15);
+    csd[15] = (sim_crc7(csd, 15) << 1) | 0x01;
+}
+
+static void sim_scr(sdcard_sim_t *sim, uint8_t *scr) {
+    memset(scr, 0, 8);
+    scr[0] = 0x02;
+    scr[1] = 0x35;
+    scr[2] = 0x80;
+    scr[3] = sim->cmd23 ? 0x02 : 0x00;
+}
+
+
+//__> OUTPUT _____________________________________________________________________________________
+//an R1 and whatever trails it ~ one NCR byte goes out first
+static void sim_respond(sdcard_sim_t *sim, uint8_t r1, const uint8_t *extra, int n) {
+    sim->resp[0] = 0xFF;
+    sim->resp[1] = r1 | (sim->idle ? R1_IDLE : 0);
+    if (n) memcpy(sim->resp + 2, extra, n);
+    sim->resp_len = 2 + n;
+    sim->resp_pos = 0;
+}
+
+//a data response token ~ it goes out on the byte after the CRC
+static void sim_reply(sdcard_sim_t *sim, uint8_t token) {
+    sim->resp[0]  = token;
+    sim->resp_len = 1;
+    sim->resp_pos = 0;
+}
+
+static void sim_packet(sdcard_sim_t *sim, const uint8_t *payload, int len, uint64_t at) {
+    uint16_t crc = sim_crc16(payload, len);
+    sim->data[0] = TOKEN_DATA;
+    memcpy(sim->data + 1, payload, len);
+    sim->data[len + 1] = crc >> 8;
+    sim->data[len + 2] = crc & 0xFF;
+    sim->data_len = len + 3;
+    sim->data_end = len + 1;
+    sim->data_pos = 0;
+    sim->data_at  = at;
+}
+
+//loads the next block of a read ~ running off the card sends a data error token and ends the run
+static void sim_next_block(sdcard_sim_t *sim, uint64_t at) {
+    if (sim->addr >= sim->blocks) {
+        sim->data[0]  = TOKEN_RANGE;
+        sim->data_len = 1;
+        sim->data_end = 0;
+        sim->data_pos = 0;
+        sim->data_at  = at;
+        sim->mode     = SIM_IDLE;
+        return;
+    }
+
+    uint8_t block[SIM_BLOCK];
+    sim_load(sim, sim->addr++, block);
+    sim_packet(sim, block, SIM_BLOCK, at);
+    sim->blocks_read++;
+    if (sim->counted) sim->count--;
+}
+
+//the last byte of a packet went out
+static void sim_sent(sdcard_sim_t *sim, uint64_t now) {
+    if (sim->mode != SIM_READ) return;
+
+    if (sim->multi && !(sim->counted && sim->count == 0)) sim_next_block(sim, now + sim->block_ns);
+    else sim->mode = SIM_IDLE;
+}
+
+static uint8_t sim_out(sdcard_sim_t *sim, uint64_t now, uint32_t hz) {
+    if (sim->resp_pos < sim->resp_len) return sim->resp[sim->resp_pos++];
+
+    if (sim->data_pos < sim->data_len) {
+        if (now < sim->data_at) return 0xFF;
+
+        //an overclocked card still frames its packets ~ only the payload suffers
+        uint8_t b = sim->data[sim->data_pos];
+        if (sim->max_hz && hz > sim->max_hz && sim->data_pos >= 1 && sim->data_pos < sim->data_end) b ^= 0x10;
+
+        if (++sim->data_pos == sim->data_len) sim_sent(sim, now);
+        return b;
+    }
+
+    return (now < sim->busy_until) ? 0x00 : 0xFF;
+}
+
+
+//__> INPUT _____________________________________________________________________________________
+//starts a data transfer ~ a CMD23 count waiting in `preset` belongs to this run
+static void sim_run(sdcard_sim_t *sim, uint8_t mode, bool multi, uint32_t addr) {
+    sim->mode    = mode;
+    sim->multi   = multi;
+    sim->addr    = addr;
+    sim->counted = multi && sim->preset;
+    sim->count   = sim->preset;
+    sim->preset  = 0;
+}
+
+static void sim_command(sdcard_sim_t *sim, uint64_t now) {
+    uint8_t  cmd = sim->frame[0] & 0x3F;
+    uint32_t arg = ((uint32_t)sim->frame[1] << 24) | (sim->frame[2] << 16) | (sim->frame[3] << 8) | sim->frame[4];
+    bool     app = sim->app;
+    uint8_t  buf[64];
+
+    sim->app = false;
+    sim->cmds[cmd]++;
+
+    //CMD0 always carries a real CRC7 ~ everything else only once CMD59 turned checking on
+    if ((sim->crc_on || cmd == 0) && ((sim_crc7(sim->frame, 5) << 1) | 0x01) != sim->frame[5]) {
+        sim_respond(sim, R1_CRC, NULL, 0);
+        return;
+    }
+
+    switch (cmd) {
+        case 0:
+            sim->idle     = true;
+            sim->crc_on   = false;
+            sim->inits    = 0;
+            sim->mode     = SIM_IDLE;
+            sim->preset   = 0;
+            sim->data_len = sim->data_pos = 0;
+            sim->busy_until = 0;
+            sim_respond(sim, 0, NULL, 0);
+            break;
+        case 8:
+            sim_respond(sim, 0, (uint8_t []){0x00, 0x00, (arg >> 8) & 0x0F, arg & 0xFF}, 4);
+            break;
+        case 9:
+            sim_respond(sim, 0, NULL, 0);
+            sim_csd(sim, buf);
+            sim_packet(sim, buf, 16, now);
+            break;
+        case 12:
+            //the run stops where it is ~ a block half sent is dropped
+            if (sim->mode != SIM_READ) {
+                sim_respond(sim, R1_ILLEGAL, NULL, 0);
+                break;
+            }
+            sim->mode     = SIM_IDLE;
+            sim->data_len = sim->data_pos = 0;
+            sim_respond(sim, 0, NULL, 0);
+            break;
+        case 13:
+            //ACMD13 is an R2 followed by the 64 byte SD status
+            sim_respond(sim, 0, (uint8_t []){0x00}, 1);
+            if (app) {
+                memset(buf, 0, 64);
+                buf[10] = SIM_AU_SIZE << 4;
+                sim_packet(sim, buf, 64, now);
+            }
+            break;
+        case 16:
+            sim_respond(sim, (arg == SIM_BLOCK) ? 0 : R1_PARAM, NULL, 0);
+            break;
+        case 17:
+        case 18:
+        case 24:
+        case 25:
+            if (sim->idle || arg >= sim->blocks) {
+                sim_respond(sim, sim->idle ? R1_ILLEGAL : R1_ADDR, NULL, 0);
+                break;
+            }
+            sim_respond(sim, 0, NULL, 0);
+            if (cmd < 24) {
+                sim_run(sim, SIM_READ, cmd == 18, arg);
+                sim_next_block(sim, now + sim->token_ns);
+            }
+            else sim_run(sim, SIM_WRITE, cmd == 25, arg);
+            break;
+        case 23:
+            //ACMD23 only sets up pre-erase ~ accepted and ignored
+            if (!app && !sim->cmd23) {
+                sim_respond(sim, R1_ILLEGAL, NULL, 0);
+                break;
+            }
+            if (!app) sim->preset = arg;
+            sim_respond(sim, 0, NULL, 0);
+            break;
+        case 32:
+        case 33:
+            sim->erase[cmd - 32] = arg;
+            sim_respond(sim, 0, NULL, 0);
+            break;
+        case 38:
+            for (uint32_t b = sim->erase[0]; b <= sim->erase[1] && b < sim->blocks; b++) {
+                uint8_t block[SIM_BLOCK];
+                memset(block, 0xFF, SIM_BLOCK);
+                sim_store(sim, b, block);
+            }
+            sim->busy_until = now + sim->busy_ns;
+            sim_respond(sim, 0, NULL, 0);
+            break;
+        case 41:
+            //ready on the second call ~ enough for the init loop to go round once
+            if (!app) {
+                sim_respond(sim, R1_ILLEGAL, NULL, 0);
+                break;
+            }
+            if (++sim->inits >= 2) sim->idle = false;
+            sim_respond(sim, 0, NULL, 0);
+            break;
+        case 51:
+            if (!app) {
+                sim_respond(sim, R1_ILLEGAL, NULL, 0);
+                break;
+            }
+            sim_respond(sim, 0, NULL, 0);
+            sim_scr(sim, buf);
+            sim_packet(sim, buf, 8, now);
+            break;
+        case 55:
+            sim->app = true;
+            sim_respond(sim, 0, NULL, 0);
+            break;
+        case 58:
+            //OCR ~ power up status and CCS once initialised
+            sim_respond(sim, 0, (uint8_t []){sim->idle ? 0x00 : 0xC0, 0xFF, 0x80, 0x00}, 4);
+            break;
+        case 59:
+            sim->crc_on = arg & 0x01;
+            sim_respond(sim, 0, NULL, 0);
+            break;
+        default:
+            sim_respond(sim, R1_ILLEGAL, NULL, 0);
+            break;
+    }
+}
+
+//a whole data packet arrived ~ it is checked, stored and answered
+static void sim_received(sdcard_sim_t *sim, uint64_t now) {
+    uint16_t sum = (sim->rx[SIM_BLOCK] << 8) | sim->rx[SIM_BLOCK + 1];
+
+    if (sim->crc_on && sim_crc16(sim->rx, SIM_BLOCK) != sum) {
+        sim->crc_rejects++;
+        sim_reply(sim, RESP_CRC_ERROR);
+        sim->mode = sim->multi ? SIM_WRITE : SIM_IDLE;
+        return;
+    }
+
+    if (sim->addr >= sim->blocks) {
+        sim_reply(sim, RESP_WR_ERROR);
+        sim->mode = sim->multi ? SIM_WRITE : SIM_IDLE;
+        return;
+    }
+
+    sim_store(sim, sim->addr++, sim->rx);
+    sim->blocks_written++;
+    sim_reply(sim, RESP_ACCEPTED);
+
+    //the end of a transaction programs for longer than a block inside a run
+    bool last = !sim->multi || (sim->counted && --sim->count == 0);
+    sim->busy_until = now + (last ? sim->busy_ns : sim->block_ns);
+    sim->mode       = last ? SIM_IDLE : SIM_WRITE;
+}
+
+static void sim_in(sdcard_sim_t *sim, uint8_t mosi, uint64_t now) {
+    if (sim->mode == SIM_RECEIVE) {
+        sim->rx[sim->rx_len++] = mosi;
+        if (sim->rx_len == SIM_BLOCK + 2) sim_received(sim, now);
+        return;
+    }
+
+    if (sim->framed) {
+        sim->frame[sim->framed++] = mosi;
+        if (sim->framed == 6) {
+            sim->framed = 0;
+            sim_command(sim, now);
+        }
+        return;
+    }
+
+    //start bit 0, transmission bit 1
+    if ((mosi & 0xC0) == 0x40) {
+        sim->frame[0] = mosi;
+        sim->framed   = 1;
+        return;
+    }
+
+    if (sim->mode != SIM_WRITE) return;
+
+    if (mosi == (sim->multi ? TOKEN_CMD25 : TOKEN_DATA)) {
+        sim->mode   = SIM_RECEIVE;
+        sim->rx_len = 0;
+    }
+    else if (mosi == TOKEN_STOP_TRAN && sim->multi) {
+        sim->stop_tran++;
+        sim->mode       = SIM_IDLE;
+        sim->busy_until = now + sim->busy_ns;
+    }
+}
+
+uint8_t sdcard_sim_xfer(sdcard_sim_t *sim, uint8_t mosi, uint64_t now, uint32_t hz) {
+    if (!sim->selected) return 0xFF;
+
+    sim->bytes++;
+    uint8_t miso = sim_out(sim, now, hz);
+    sim_in(sim, mosi, now);
+    return miso;
+}
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef SDCARD_SIM_H
+#define SDCARD_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+//simulated SDHC card in SPI mode ~ answers one byte per clocked byte, backed by a file or by memory
+//times are nanoseconds on the host's virtual clock
+
+#define SIM_BLOCK       (512)
+#define SIM_PACKET      (SIM_BLOCK + 3)     //start token, payload, CRC16
+
+#define SIM_IDLE        (0)                 //between transactions
+#define SIM_READ        (1)                 //CMD17/CMD18 data is going out
+#define SIM_WRITE       (2)                 //CMD24/CMD25 is waiting for a start token
+#define SIM_RECEIVE     (3)                 //a data packet is coming in
+
+typedef struct {
+    //backing store ~ `mem` when there is no image file
+    FILE     *file;
+    uint8_t  *mem;
+    uint32_t  blocks;
+
+    //timing and limits
+    uint64_t  token_ns;     //access time before the first block of a read
+    uint64_t  block_ns;     //gap between blocks of a run ~ read access or programming inside CMD25
+    uint64_t  busy_ns;      //programming at the end of a write transaction
+    uint32_t  max_hz;       //read data comes back garbled above this clock ~ 0 is unlimited
+    bool      cmd23;        //the SCR advertises CMD23
+
+    //protocol state
+    bool      selected;
+    bool      idle;
+    bool      app;          //last command was CMD55
+    bool      crc_on;
+    uint8_t   inits;        //ACMD41 calls answered so far
+    uint8_t   mode;
+    bool      multi;
+    uint32_t  addr;         //next block of the current run
+    bool      counted;      //the run was announced with CMD23
+    uint32_t  count;        //blocks left in a counted run
+    uint32_t  preset;       //CMD23 argument waiting for the next run
+    uint32_t  erase[2];
+
+    uint8_t   frame[6];
+    uint8_t   framed;
+
+    uint8_t   resp[8];      //R1 and its trailing bytes ~ always ahead of data
+    uint8_t   resp_len;
+    uint8_t   resp_pos;
+
+    uint8_t   data[SIM_PACKET];
+    uint16_t  data_len;
+    uint16_t  data_pos;
+    uint16_t  data_end;     //payload bytes that can be garbled end here
+    uint64_t  data_at;      //the packet starts once the clock passes this
+
+    uint8_t   rx[SIM_BLOCK + 2];
+    uint16_t  rx_len;
+
+    uint64_t  busy_until;
+
+    //counters
+    uint64_t  bytes;
+    uint32_t  cmds[64];
+    uint32_t  stop_tran;
+    uint32_t  blocks_read;
+    uint32_t  blocks_written;
+    uint32_t  crc_rejects;
+} sdcard_sim_t;
+
+//image may be NULL for a card that only lives in memory ~ false when the image can't be opened
+bool    sdcard_sim_init(sdcard_sim_t *sim, const char *image, uint32_t mb);
+void    sdcard_sim_deinit(sdcard_sim_t *sim);
+void    sdcard_sim_select(sdcard_sim_t *sim, bool selected);
+void    sdcard_sim_reset_counters(sdcard_sim_t *sim);
+
+//exchanges one byte at `hz` ~ returns what the card drives on MISO
+uint8_t sdcard_sim_xfer(sdcard_sim_t *sim, uint8_t mosi, uint64_t now, uint32_t hz);
+
+#endif
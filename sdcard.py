@@ -1,7 +1,14 @@
-import time, uos
-from utime import sleep_ms
+import time, uos, uasyncio
+from utime import sleep_ms, ticks_us, ticks_diff
 from usys import path as syspath
 from machine import Pin, SPI
+from uctypes import addressof
+
+# viper FIFO access on the rp2 port ~ without it every byte goes through machine.SPI
+try:
+    import sdfast
+except (ImportError, SyntaxError, ValueError):
+    sdfast = None
 
 _BAUD        = const(0x500000) #5 Mb ~ can be overwritten in SDCard constructor
 
@@ -111,6 +118,40 @@ class SDCard(object):
                 
         self.mount() if automount else None
         return True
+        
+    #__> Detect And Connect To Card Without Blocking Other Tasks
+    async def adetect(self, automount:bool=True, interval:int=500) -> bool:
+        if not self.__conn:
+            if not self.detected:
+                print('Waiting For A Card To Be Inserted')
+                while not self.detected:
+                    await uasyncio.sleep_ms(interval)
+                    
+            await uasyncio.sleep_ms(250) #an extra little wait to make sure the sdcard is fully seated before connecting
+            
+        return self.detect(automount)
+        
+    #__> Awaitable Block I/O
+    async def areadblocks(self, block_num:int, buf:bytearray) -> None:
+        if self.__warnings:
+            return
+        await self.__sd.areadblocks(block_num, buf)
+        
+    async def awriteblocks(self, block_num:int, buf:bytearray) -> None:
+        if self.__warnings:
+            return
+        await self.__sd.awriteblocks(block_num, buf)
+        
+    #__> Vectored Block I/O
+    def readv(self, reqs) -> None:
+        if self.__warnings:
+            return
+        self.__sd.readv(reqs)
+        
+    def writev(self, reqs) -> None:
+        if self.__warnings:
+            return
+        self.__sd.writev(reqs)
     
     #_> Mount Card
     def mount(self) -> None:
@@ -148,11 +189,15 @@ _CMD0               = const(0x40)    # CMD0 : init card; should return _IDLE_STA
 _CMD8               = const(0x48)    # CMD8 : determine card version
 _CMD9               = const(0x49)    # CMD9 : response R2 (R1 byte + 16-byte block read)
 _CMD12              = const(0x4C)    # CMD12: forces card to stop transmission in Multiple Block Read Operation
+_CMD13              = const(0x4D)    # ACMD13: read SD status. AU_SIZE sits in bits 431:428
 _CMD16              = const(0x50)    # CMD16: set block length to 512 bytes
 _CMD17              = const(0x51)    # CMD17: set read address for single block
 _CMD18              = const(0x52)    # CMD18: set read address for multiple blocks
 _CMD24              = const(0x58)    # CMD24: set write address for single block
 _CMD25              = const(0x59)    # CMD25: set write address for first block
+_CMD32              = const(0x60)    # CMD32: set first block to erase
+_CMD33              = const(0x61)    # CMD33: set last block to erase
+_CMD38              = const(0x66)    # CMD38: erase the selected range
 _CMD41              = const(0x69)    # CMD41: host capacity support information / activates card's initialization process.
 _CMD55              = const(0x77)    # CMD55: next command is app command
 _CMD58              = const(0x7a)    # CMD58: read OCR register. CCS bit is assigned to OCR[30]
@@ -161,6 +206,14 @@ _FF                 = b'\xFF'
 _BLOCK              = const(0x200)
 
 _CMD_TIMEOUT        = const(100)
+_SPIN_US            = const(200)     # token polling budget before napping between polls
+_POLLS              = const(128)     # bytes a viper wait clocks before handing back to check the clock
+_TOKEN_US           = const(100000)  # read access deadline ~ 100 ms for SDHC/SDXC
+_BUSY_US            = const(500000)  # programming deadline ~ 500 ms for SDXC
+_AU_DEFAULT         = const(0x2000)  # 4 MB in blocks ~ used when the card doesn't report its allocation unit
+
+# AU_SIZE codes 1..F in blocks ~ 16 KB doubling to 4 MB, then 8, 12, 16, 24, 32 and 64 MB
+_AU_BLOCKS          = (_AU_DEFAULT, 0x20, 0x40, 0x80, 0x100, 0x200, 0x400, 0x800, 0x1000, 0x2000, 0x4000, 0x6000, 0x8000, 0xC000, 0x10000, 0x20000)
 
 _IDLE_STATE         = const(0x01)
 _ILLEGAL_CMD        = const(0x04)
@@ -181,8 +234,15 @@ class SDObject(object):
             self.led = Pin(led, Pin.OUT)
             self.led(0)
         
+        # reused on every command and poll ~ steady-state block I/O allocates nothing
         self.tokenbuf = bytearray(1)
-        self.buf_mv   = memoryview(bytearray(_BLOCK))
+        self.cmdbuf   = bytearray(6)
+        self.vaddr    = -1
+        self.vlist    = []
+        self.estart   = 0                                    # erase ioctls not sent yet ~ one range of blocks that continue each other
+        self.ecount   = 0
+        self.unit     = sdfast.unit(spi) if sdfast else -1  # -1 keeps every transfer on machine.SPI
+        self.lock     = uasyncio.Lock()                      # held across each awaitable call ~ the card sits in an open run while it yields
         
         self.type     = None
         
@@ -215,19 +275,32 @@ class SDObject(object):
             
         csd = None
 
-        if self.cmd(_CMD16, _BLOCK << 8):
+        if self.cmd(_CMD16, _BLOCK):
             raise OSError('Can\'t Set Block Size')
+            
+        # SD status ~ erases are split on allocation unit boundaries
+        self.au = _AU_DEFAULT
+        self.cmd(_CMD55)
+        if not self.cmd(_CMD13, final=1, release=False):
+            status = bytearray(64)
+            self.readinto(status)
+            if status[10] >> 4:
+                self.au = _AU_BLOCKS[status[10] >> 4]
+            status = None
+        else:
+            self.cs(1)
+            self.spi.write(_FF)
 
         self.spi.init(baudrate=baudrate, phase=0, polarity=0)
         
     def versioning(self):
-        r = self.cmd(_CMD8, 0x01AA << 8, 0x87, 4)
+        r = self.cmd(_CMD8, 0x01AA, 0x87, 4)
         if r == _IDLE_STATE:
             for i in range(_CMD_TIMEOUT):
                 sleep_ms(50)
                 self.cmd(_CMD58, final=4)
                 self.cmd(_CMD55)
-                if not self.cmd(_CMD41, 0x40 << 32):
+                if not self.cmd(_CMD41, 0x40000000):
                     self.cmd(_CMD58, final=4)
                     self.cdv = 1
                     self.type = '[SDCard v2]'
@@ -247,145 +320,485 @@ class SDObject(object):
     def cmd(self, cmd:int, arg:int=0, crc:int=0, final:int=0, release:bool=True, skip:bool=False) -> int:
         self.cs(0)
         
-        self.spi.write((cmd << 40 | arg | crc).to_bytes(6, 'big'))
+        if self.unit > -1:
+            r = sdfast.command(self.unit, cmd << 8 | crc | skip << 16, arg, _CMD_TIMEOUT)
+            if r != 0xFF:
+                return self.response(r, final, release)
+        else:
+            c    = self.cmdbuf
+            c[0] = cmd
+            c[1] = arg >> 24 & 0xFF
+            c[2] = arg >> 16 & 0xFF
+            c[3] = arg >> 8 & 0xFF
+            c[4] = arg & 0xFF
+            c[5] = crc
+            self.spi.write(c)
 
-        if skip:
-            self.spi.readinto(self.tokenbuf, 0xFF)
+            if skip:
+                self.spi.readinto(self.tokenbuf, 0xFF)
 
-        # wait for the response (response[7] == 0)
-        for i in range(_CMD_TIMEOUT):
-            self.spi.readinto(self.tokenbuf, 0xFF)
-            if not (self.tokenbuf[0] & 0x80):
-                # this could be a big-endian integer that we are getting here
-                for j in range(final):
-                    self.spi.write(_FF)
-                if release:
-                    self.cs(1)
-                    self.spi.write(_FF)
-                return self.tokenbuf[0]
+            # wait for the response (response[7] == 0)
+            for i in range(_CMD_TIMEOUT):
+                self.spi.readinto(self.tokenbuf, 0xFF)
+                if not (self.tokenbuf[0] & 0x80):
+                    return self.response(self.tokenbuf[0], final, release)
 
         # timeout
         self.cs(1)
         self.spi.write(_FF)
         return -1
         
+    # the rest of a longer response ~ CS stays asserted when the caller reads data next
+    def response(self, r:int, final:int, release:bool) -> int:
+        # this could be a big-endian integer that we are getting here
+        for j in range(final):
+            self.spi.write(_FF)
+        if release:
+            self.cs(1)
+            self.spi.write(_FF)
+        return r
+        
     def readinto(self, buf:bytearray) -> None:
         self.cs(0)
 
-        # read until start byte (0xff)
-        for _ in range(_CMD_TIMEOUT):
+        # read until start byte (0xfe) ~ spin first, then nap between polls until the deadline
+        # the viper path reads the packet as soon as the token shows up
+        start = ticks_us()
+        while True:
+            if self.unit > -1:
+                if sdfast.read_packet(self.unit, buf, len(buf), _POLLS) == _TOKEN_DATA:
+                    break
+            else:
+                self.spi.readinto(self.tokenbuf, 0xFF)
+                if self.tokenbuf[0] == _TOKEN_DATA:
+                    break
+            waited = ticks_diff(ticks_us(), start)
+            if waited > _TOKEN_US:
+                self.cs(1)
+                raise OSError('Response Timeout')
+            if waited > _SPIN_US:
+                sleep_ms(1)
+
+        if self.unit < 0:
+            # read data
+            self.spi.readinto(buf, 0xFF)
+
+            # read checksum
+            self.spi.write(_FF)
+            self.spi.write(_FF)
+
+        self.cs(1)
+        self.spi.write(_FF)
+        
+    # readinto for uasyncio ~ other tasks run between polls once the spin budget is used
+    async def areadinto(self, buf:bytearray) -> None:
+        self.cs(0)
+
+        start = ticks_us()
+        while True:
             self.spi.readinto(self.tokenbuf, 0xFF)
             if self.tokenbuf[0] == _TOKEN_DATA:
                 break
-            sleep_ms(1)
-        else:
-            self.cs(1)
-            raise OSError('Response Timeout')
-
-        # read data
-        self.spi.write_readinto(self.buf_mv[: len(buf)], buf)
+            waited = ticks_diff(ticks_us(), start)
+            if waited > _TOKEN_US:
+                self.cs(1)
+                raise OSError('Response Timeout')
+            if waited > _SPIN_US:
+                await uasyncio.sleep_ms(0)
 
-        # read checksum
+        self.spi.readinto(buf, 0xFF)
         self.spi.write(_FF)
         self.spi.write(_FF)
 
         self.cs(1)
         self.spi.write(_FF)
 
-    def write(self, token:int, buf:bytearray) -> None:
+    # sends one data packet ~ False means the card rejected it and CS was released
+    def packet(self, token:int, buf:bytearray) -> bool:
         self.cs(0)
 
-        # send: start of block, data, checksum
-        self.spi.read(1, token)
-        self.spi.write(buf)
-        self.spi.write(_FF)
-        self.spi.write(_FF)
+        if self.unit > -1:
+            r = sdfast.write_packet(self.unit, token, buf, len(buf))
+        else:
+            # send: start of block, data, checksum
+            self.spi.readinto(self.tokenbuf, token)
+            self.spi.write(buf)
+            self.spi.write(_FF)
+            self.spi.write(_FF)
+            self.spi.readinto(self.tokenbuf, 0xFF)
+            r = self.tokenbuf[0] & 0x1F
 
         # check the response
-        if (self.spi.read(1, 0xFF)[0] & 0x1F) != 0x05:
+        if r != 0x05:
             self.cs(1)
             self.spi.write(_FF)
-            return
+            return False
+            
+        return True
+
+    def write(self, token:int, buf:bytearray) -> None:
+        if not self.packet(token, buf):
+            self.rejected(token)
+        self.busy()
+        
+    # a block the card didn't accept is lost ~ an open run gets the stop token so the card listens to the next command
+    def rejected(self, token:int) -> None:
+        if token == _TOKEN_CMD25:
+            self.write_token(_TOKEN_STOP_TRAN)
+        raise OSError(5)  # EIO
 
-        # wait for write to finish
-        while not self.spi.read(1, 0xFF)[0]:
-            pass
+    def write_token(self, token:int) -> None:
+        self.cs(0)
+        
+        self.spi.readinto(self.tokenbuf, token)
+        self.spi.write(_FF)
+        self.busy()
+        
+    # waits for the write or erase to finish, then lets go of the card
+    def busy(self) -> None:
+        if self.unit > -1:
+            while not sdfast.wait(self.unit, 0x00, _POLLS):
+                pass
+        else:
+            self.spi.readinto(self.tokenbuf, 0xFF)
+            while not self.tokenbuf[0]:
+                self.spi.readinto(self.tokenbuf, 0xFF)
 
         self.cs(1)
         self.spi.write(_FF)
+        
+    # waits out programming with CS held ~ other tasks run once the spin budget is used
+    async def abusy(self) -> None:
+        start = ticks_us()
+        while True:
+            self.spi.readinto(self.tokenbuf, 0xFF)
+            if self.tokenbuf[0]:
+                break
+            waited = ticks_diff(ticks_us(), start)
+            if waited > _BUSY_US:
+                self.cs(1)
+                raise OSError(110)  # ETIMEDOUT
+            if waited > _SPIN_US:
+                await uasyncio.sleep_ms(0)
 
-    def write_token(self, token:int) -> None:
+        self.cs(1)
+        self.spi.write(_FF)
+        
+    async def awrite(self, token:int, buf:bytearray) -> None:
+        # awriteblocks ends an open run through abort()
+        if not self.packet(token, buf):
+            raise OSError(5)  # EIO
+        await self.abusy()
+            
+    async def awrite_token(self, token:int) -> None:
         self.cs(0)
         
-        self.spi.read(1, token)
+        self.spi.readinto(self.tokenbuf, token)
         self.spi.write(_FF)
+        await self.abusy()
         
-        # wait for write to finish
-        while not self.spi.read(1, 0xFF)[0]:
-            pass
-
+    # lets go of the card after an error or a cancel ~ an open run is ended so the card listens to the next command
+    def abort(self, cmd:int) -> None:
         self.cs(1)
         self.spi.write(_FF)
+        if cmd == _CMD18:
+            self.cmd(_CMD12, 0, 0xFF, skip=True)
+        elif cmd == _CMD25:
+            self.write_token(_TOKEN_STOP_TRAN)
+        self.indicator(False)
     
+    # an awaitable call holds the card while it yields ~ other calls are refused like in the C port
+    def idle(self) -> None:
+        if self.lock.locked():
+            raise OSError(16)  # EBUSY
+        
     def indicator(self, on:bool) -> None:
         if not self.led is None:
             self.led(on)
+            
+    # one view per block of the caller's buffer ~ kept until a buffer at another address comes in, so repeated I/O doesn't allocate
+    def views(self, buf:bytearray, nblocks:int) -> list:
+        addr = addressof(buf)
+        if addr != self.vaddr or nblocks != len(self.vlist):
+            mv = memoryview(buf)
+            self.vlist = [mv[_BLOCK*i : _BLOCK*(i+1)] for i in range(nblocks)]
+            self.vaddr = addr
+        return self.vlist
                 
     def readblocks(self, block_num:int, buf:bytearray) -> None:
-        nblocks, err = divmod(len(buf), _BLOCK)
-        assert nblocks and not err, 'Invalid Buffer Length'
+        nblocks = len(buf) // _BLOCK
+        assert nblocks and not len(buf) % _BLOCK, 'Invalid Buffer Length'
         
+        self.idle()
+        self.erase_settle(block_num, nblocks, False)
         self.indicator(True)
         
         if nblocks == 1:
-            if self.cmd(_CMD17, int(block_num * self.cdv) << 8, release=False):
+            if self.cmd(_CMD17, int(block_num * self.cdv), release=False):
                 self.cs(1)
                 raise OSError(5)  # EIO
                 
             self.readinto(buf)
         else:
-            if self.cmd(_CMD18, int(block_num * self.cdv) << 8, release=False):
+            if self.cmd(_CMD18, int(block_num * self.cdv), release=False):
                 self.cs(1)
                 raise OSError(5)  # EIO
                 
-            mv = memoryview(buf)
-            for i in range(nblocks):
-                self.readinto(mv[_BLOCK+int(_BLOCK*(i-1)) : _BLOCK+int(_BLOCK*i)])
+            self.read_run(buf, nblocks)
                 
             if self.cmd(_CMD12, 0, 0xFF, skip=True):
                 raise OSError(5)  # EIO
                 
         self.indicator(False)
+        
+    # the next nblocks of an open CMD18 run into buf
+    def read_run(self, buf:bytearray, nblocks:int) -> None:
+        if self.unit > -1:
+            addr = addressof(buf)
+            done = 0
+            while done < nblocks:
+                self.cs(0)
+                done += sdfast.read_blocks(self.unit, addr + _BLOCK*done, nblocks - done, _POLLS)
+                # a block the card is slow to send is waited out against the deadline
+                if done < nblocks:
+                    self.readinto(self.views(buf, nblocks)[done])
+                    done += 1
+        else:
+            for view in self.views(buf, nblocks):
+                self.readinto(view)
     
     def writeblocks(self, block_num:int, buf:bytearray) -> None:
-        nblocks, err = divmod(len(buf), _BLOCK)
-        assert nblocks and not err, 'Invalid Buffer Length'
+        nblocks = len(buf) // _BLOCK
+        assert nblocks and not len(buf) % _BLOCK, 'Invalid Buffer Length'
         
+        self.idle()
+        self.erase_settle(block_num, nblocks, True)
         self.indicator(True)
         
         if nblocks == 1:
-            if self.cmd(_CMD24, int(block_num * self.cdv) << 8):
+            if self.cmd(_CMD24, int(block_num * self.cdv)):
                 raise OSError(5)  # EIO
                 
             self.write(_TOKEN_DATA, buf)
         else:
-            if self.cmd(_CMD25, int(block_num * self.cdv) << 8):
+            if self.cmd(_CMD25, int(block_num * self.cdv)):
                 raise OSError(5)  # EIO
                 
-            mv = memoryview(buf)
-            for i in range(nblocks):
-                self.write(_TOKEN_CMD25, mv[_BLOCK+int(_BLOCK*(i-1)) : _BLOCK+int(_BLOCK*i)])
+            self.write_run(buf, nblocks)
+                
+            self.write_token(_TOKEN_STOP_TRAN)
+            
+        self.indicator(False)
+        
+    # the next nblocks of an open CMD25 run out of buf
+    def write_run(self, buf:bytearray, nblocks:int) -> None:
+        if self.unit > -1:
+            addr = addressof(buf)
+            done = 0
+            while done < nblocks:
+                self.cs(0)
+                r = sdfast.write_blocks(self.unit, addr + _BLOCK*done, nblocks - done, _POLLS)
+                done += r >> 2
+                # the block that stopped the run is finished here like write() would
+                if r & sdfast.BUSY:
+                    self.busy()
+                    done += 1
+                elif r & sdfast.REJECTED:
+                    self.cs(1)
+                    self.spi.write(_FF)
+                    self.rejected(_TOKEN_CMD25)
+            self.cs(1)
+            self.spi.write(_FF)
+        else:
+            for view in self.views(buf, nblocks):
+                self.write(_TOKEN_CMD25, view)
+                
+    # (block, buf) pairs sorted by block and grouped into [start, end, bufs] runs of blocks that continue each other
+    def runs(self, reqs) -> list:
+        runs = []
+        for block, buf in sorted(reqs, key=lambda r: r[0]):
+            nblocks = len(buf) // _BLOCK
+            assert nblocks and not len(buf) % _BLOCK, 'Invalid Buffer Length'
+            if runs and runs[-1][1] == block:
+                runs[-1][1] += nblocks
+                runs[-1][2].append(buf)
+            else:
+                runs.append([block, block + nblocks, [buf]])
+        return runs
+        
+    # many buffers, one CMD18 per run of continuing blocks
+    def readv(self, reqs) -> None:
+        self.idle()
+        runs = self.runs(reqs)
+        self.indicator(True)
+        
+        for start, end, bufs in runs:
+            self.erase_settle(start, end - start, False)
+            cmd = _CMD17 if end - start == 1 else _CMD18
+            if self.cmd(cmd, int(start * self.cdv), release=False):
+                self.cs(1)
+                raise OSError(5)  # EIO
+                
+            if cmd == _CMD17:
+                self.readinto(bufs[0])
+                continue
+                
+            for buf in bufs:
+                self.read_run(buf, len(buf) // _BLOCK)
+                
+            if self.cmd(_CMD12, 0, 0xFF, skip=True):
+                raise OSError(5)  # EIO
+                
+        self.indicator(False)
+        
+    # many buffers, one CMD25 per run of continuing blocks ~ overlapping requests are refused
+    def writev(self, reqs) -> None:
+        self.idle()
+        runs = self.runs(reqs)
+        for i in range(1, len(runs)):
+            assert runs[i][0] >= runs[i-1][1], 'Overlapping Blocks'
+        self.indicator(True)
+        
+        for start, end, bufs in runs:
+            self.erase_settle(start, end - start, True)
+            cmd = _CMD24 if end - start == 1 else _CMD25
+            if self.cmd(cmd, int(start * self.cdv)):
+                raise OSError(5)  # EIO
+                
+            if cmd == _CMD24:
+                self.write(_TOKEN_DATA, bufs[0])
+                continue
+                
+            for buf in bufs:
+                self.write_run(buf, len(buf) // _BLOCK)
                 
             self.write_token(_TOKEN_STOP_TRAN)
             
         self.indicator(False)
     
+    async def areadblocks(self, block_num:int, buf:bytearray) -> None:
+        nblocks, err = divmod(len(buf), _BLOCK)
+        assert nblocks and not err, 'Invalid Buffer Length'
+        
+        async with self.lock:
+            self.erase_settle(block_num, nblocks, False)
+            self.indicator(True)
+            
+            cmd = _CMD17 if nblocks == 1 else _CMD18
+            if self.cmd(cmd, int(block_num * self.cdv), release=False):
+                self.cs(1)
+                raise OSError(5)  # EIO
+                
+            mv = memoryview(buf)
+            try:
+                for i in range(nblocks):
+                    await self.areadinto(mv[_BLOCK*i : _BLOCK*(i+1)])
+            except BaseException:
+                self.abort(cmd)
+                raise
+                
+            if cmd == _CMD18 and self.cmd(_CMD12, 0, 0xFF, skip=True):
+                raise OSError(5)  # EIO
+                
+            self.indicator(False)
+    
+    async def awriteblocks(self, block_num:int, buf:bytearray) -> None:
+        nblocks, err = divmod(len(buf), _BLOCK)
+        assert nblocks and not err, 'Invalid Buffer Length'
+            
+        async with self.lock:
+            self.erase_settle(block_num, nblocks, True)
+            self.indicator(True)
+            
+            cmd = _CMD24 if nblocks == 1 else _CMD25
+            if self.cmd(cmd, int(block_num * self.cdv)):
+                raise OSError(5)  # EIO
+                
+            mv = memoryview(buf)
+            try:
+                if cmd == _CMD24:
+                    await self.awrite(_TOKEN_DATA, buf)
+                else:
+                    for i in range(nblocks):
+                        await self.awrite(_TOKEN_CMD25, mv[_BLOCK*i : _BLOCK*(i+1)])
+                    await self.awrite_token(_TOKEN_STOP_TRAN)
+            except BaseException:
+                self.abort(cmd)
+                raise
+                
+            self.indicator(False)
+    
+    # one CMD32/CMD33/CMD38 sequence ~ holds CS until the card stops signalling busy
+    def erase_range(self, first:int, last:int) -> None:
+        if self.cmd(_CMD32, int(first * self.cdv)) or self.cmd(_CMD33, int(last * self.cdv)):
+            raise OSError(5)  # EIO
+            
+        if self.cmd(_CMD38, release=False):
+            self.cs(1)
+            raise OSError(5)  # EIO
+            
+        # wait for the erase to finish
+        self.busy()
+        
+    # erases [start, start + count) one allocation unit at a time
+    def erase(self, start:int, count:int) -> None:
+        assert count > 0 and start >= 0 and start + count <= self.sectors, 'Invalid Block Range'
+        self.idle()
+        self.erase_run(start, count)
+        
+    def erase_run(self, start:int, count:int) -> None:
+        self.indicator(True)
+        
+        while count:
+            n = min(self.au - (start % self.au), count)
+            self.erase_range(start, start + n - 1)
+            start += n
+            count -= n
+            
+        self.indicator(False)
+        
+    # sends the gathered erase ioctls as one erase
+    def erase_flush(self) -> None:
+        if self.ecount:
+            count, self.ecount = self.ecount, 0
+            self.erase_run(self.estart, count)
+            
+    # littlefs erases every block right before it programs it ~ ioctls that continue the pending range are gathered instead of sent
+    def erase_defer(self, block:int) -> None:
+        assert 0 <= block < self.sectors, 'Invalid Block Range'
+        self.idle()
+        if self.ecount and block != self.estart + self.ecount:
+            self.erase_flush()
+        if not self.ecount:
+            self.estart = block
+        self.ecount += 1
+        
+    # before traffic on [block, block + nblocks) ~ a write replaces what the erase would leave, so the blocks it covers are dropped from the range
+    # a read, or a write that splits the range, sends the erase first
+    def erase_settle(self, block:int, nblocks:int, write:bool) -> None:
+        end = self.estart + self.ecount
+        if not self.ecount or block >= end or block + nblocks <= self.estart:
+            return
+        if write and block <= self.estart:
+            self.ecount = max(end - (block + nblocks), 0)
+            self.estart = block + nblocks
+        elif write and block + nblocks >= end:
+            self.ecount = block - self.estart
+        else:
+            self.erase_flush()
+    
     def ioctl(self, cmd:int, arg:int=0) -> int:
-        if cmd in (_IOCTL_INIT, _IOCTL_DEINIT, _IOCTL_SYNC):
+        if cmd == _IOCTL_INIT:
+            return 0
+        elif cmd in (_IOCTL_DEINIT, _IOCTL_SYNC):
+            self.erase_flush()
             return 0
         elif cmd == _IOCTL_BLK_COUNT:
             return self.sectors
         elif cmd == _IOCTL_BLK_SIZE:
             return _BLOCK
+        elif cmd == _IOCTL_BLK_ERASE:
+            self.erase_defer(arg)
+            return 0
         else:
             return -1
@@ -0,0 +1,164 @@
+# Viper fast path for sdcard.py on the rp2 port ~ moves bytes through the PL022 SPI FIFOs directly
+# sdcard.py keeps using machine.SPI when this can't be imported (no viper emitter, or not an RP2040)
+# every function takes the SPI unit (0 or 1) and expects chip-select to be asserted already
+# buffers can be passed as the buffer or as its address (uctypes.addressof) ~ an address plus an offset needs no slice
+import micropython
+from usys import platform
+
+_SPI0        = const(0x4003C000)   # SPI1 sits 0x4000 above it
+_DR          = const(2)            # SSPDR  ~ word offsets into the block
+_SR          = const(3)            # SSPSR
+_ICR         = const(8)            # SSPICR ~ writing 1 clears a receive overrun
+_TNF         = const(0x02)         # transmit FIFO not full
+_RNE         = const(0x04)         # receive FIFO not empty
+_BSY         = const(0x10)
+_DEPTH       = const(8)            # FIFO entries ~ bytes that can be in flight at once
+
+_BLOCK       = const(0x200)
+_TOKEN_CMD25 = const(0xFC)
+_TOKEN_DATA  = const(0xFE)
+
+# write_blocks stops on a block that needs the caller ~ the reason is in the low 2 bits, finished blocks above them
+BUSY         = const(1)            # accepted, still programming after the spin budget
+REJECTED     = const(2)            # the data response wasn't 'accepted'
+
+# the unit behind a hardware machine.SPI ~ -1 for SoftSPI or another port
+def unit(spi) -> int:
+    s = repr(spi)
+    if platform != 'rp2' or not s.startswith('SPI('):
+        return -1
+    return 1 if s[4] == '1' else 0
+
+# n bytes out of buf ~ what comes back is dropped, and the FIFOs are left empty like machine.SPI leaves them
+@micropython.viper
+def _send(unit:int, buf:ptr8, n:int):
+    spi = ptr32(_SPI0 + (unit << 14))
+    i = 0
+    while i < n:
+        if spi[_SR] & _TNF:
+            spi[_DR] = buf[i]
+            i += 1
+    while spi[_SR] & _RNE:
+        x = spi[_DR]
+    while spi[_SR] & _BSY:
+        pass
+    while spi[_SR] & _RNE:
+        x = spi[_DR]
+    spi[_ICR] = 1
+
+# clocks n bytes and the CRC16 behind them into buf ~ the CRC is dropped
+@micropython.viper
+def _receive(unit:int, buf:ptr8, n:int):
+    spi   = ptr32(_SPI0 + (unit << 14))
+    total = n + 2
+    tx    = 0
+    rx    = 0
+    while rx < total:
+        if tx < total and tx - rx < _DEPTH and (spi[_SR] & _TNF):
+            spi[_DR] = 0xFF
+            tx += 1
+        if spi[_SR] & _RNE:
+            b = int(spi[_DR])
+            if rx < n:
+                buf[rx] = b
+            rx += 1
+
+# clocks until MISO reads something other than `idle` ~ returns that byte, or `idle` after `spins` bytes
+@micropython.viper
+def wait(unit:int, idle:int, spins:int) -> int:
+    spi = ptr32(_SPI0 + (unit << 14))
+    while spins:
+        spi[_DR] = 0xFF
+        while (spi[_SR] & _RNE) == 0:
+            pass
+        b = int(spi[_DR]) & 0xFF
+        if b != idle:
+            return b
+        spins -= 1
+    return idle
+
+# head is cmd << 8 | crc, plus 0x10000 to drop the stuff byte after CMD12 ~ returns R1, or 0xFF after `tries` polls
+@micropython.viper
+def command(unit:int, head:int, arg:int, tries:int) -> int:
+    spi = ptr32(_SPI0 + (unit << 14))
+    i = 0
+    while i < 6:
+        if i == 0:
+            b = (head >> 8) & 0xFF
+        elif i == 5:
+            b = head & 0xFF
+        else:
+            b = (arg >> (32 - (i << 3))) & 0xFF
+        spi[_DR] = b
+        while (spi[_SR] & _RNE) == 0:
+            pass
+        r = int(spi[_DR])
+        i += 1
+
+    if head & 0x10000:
+        spi[_DR] = 0xFF
+        while (spi[_SR] & _RNE) == 0:
+            pass
+        r = int(spi[_DR])
+
+    while tries:
+        spi[_DR] = 0xFF
+        while (spi[_SR] & _RNE) == 0:
+            pass
+        r = int(spi[_DR]) & 0xFF
+        if (r & 0x80) == 0:
+            return r
+        tries -= 1
+    return 0xFF
+
+# waits up to `spins` bytes for a start token, then reads the packet ~ returns 0xFE once buf is filled, else the last byte seen
+@micropython.viper
+def read_packet(unit:int, buf:ptr8, n:int, spins:int) -> int:
+    t = int(wait(unit, 0xFF, spins))
+    if t == _TOKEN_DATA:
+        _receive(unit, buf, n)
+    return t
+
+# token, payload and a dummy CRC ~ returns the data response (0x05 is accepted)
+@micropython.viper
+def write_packet(unit:int, token:int, buf:ptr8, n:int) -> int:
+    spi = ptr32(_SPI0 + (unit << 14))
+    spi[_DR] = token
+    while (spi[_SR] & _RNE) == 0:
+        pass
+    r = int(spi[_DR])
+
+    _send(unit, buf, n)
+
+    i = 0
+    while i < 3:
+        spi[_DR] = 0xFF
+        while (spi[_SR] & _RNE) == 0:
+            pass
+        r = int(spi[_DR]) & 0xFF
+        i += 1
+    return r & 0x1F
+
+# the blocks of an open CMD18 run ~ returns how many arrived before one was slower than `spins`
+@micropython.viper
+def read_blocks(unit:int, buf:ptr8, n:int, spins:int) -> int:
+    addr = int(buf)
+    i = 0
+    while i < n:
+        if int(read_packet(unit, addr + (i * _BLOCK), _BLOCK, spins)) != _TOKEN_DATA:
+            return i
+        i += 1
+    return n
+
+# the blocks of an open CMD25 run, each waited out ~ returns finished blocks << 2 | BUSY or REJECTED for the one that stopped it
+@micropython.viper
+def write_blocks(unit:int, buf:ptr8, n:int, spins:int) -> int:
+    addr = int(buf)
+    i = 0
+    while i < n:
+        if int(write_packet(unit, _TOKEN_CMD25, addr + (i * _BLOCK), _BLOCK)) != 0x05:
+            return (i << 2) | REJECTED
+        if int(wait(unit, 0x00, spins)) == 0x00:
+            return (i << 2) | BUSY
+        i += 1
+    return n << 2
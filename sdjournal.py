@@ -0,0 +1,134 @@
+# Power-loss-safe record log over a raw block region ~ no filesystem, one record per 512-byte block.
+# Every block carries the log's epoch, its sequence number and a CRC32, and record `seq` always sits at block start + seq % count.
+# That makes the valid blocks of the current lap a prefix of the region, so recover() finds the head with a binary search.
+# Works on any block device with readblocks/writeblocks/ioctl: the C SDObject, SDObject from sdcard.py or a VFS block device.
+from ustruct import pack_into, unpack_from
+from urandom import getrandbits
+
+try:
+    from ubinascii import crc32
+except ImportError:
+    crc32 = None
+
+_BLOCK   = const(0x200)
+_HEADER  = const(16)            # magic, length, epoch, seq, crc ~ '<HHIII'
+_MAGIC   = const(0x4A53)        # 'SJ'
+_CHUNK   = const(8)             # blocks per read while iterating
+_SYNC    = const(3)             # ioctl: write back whatever the device still holds
+
+MAX_RECORD = const(_BLOCK - _HEADER)
+
+# bitwise CRC32 for ports built without ubinascii.crc32 ~ same polynomial and chaining
+def _crc32(data, crc:int=0) -> int:
+    crc ^= 0xFFFFFFFF
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1))
+    return crc ^ 0xFFFFFFFF
+
+if crc32 is None:
+    crc32 = _crc32
+
+class Journal(object):
+    # the log lives in blocks [start, start + count) ~ the constructor recovers the head, so appends carry on after a reset
+    def __init__(self, sd, start:int, count:int, sync:bool=True) -> None:
+        assert start >= 0 and count > 1, 'Invalid Block Range'
+        self.sd, self.start, self.count, self.sync = sd, start, count, sync
+        self.buf   = bytearray(_BLOCK * _CHUNK)
+        self.mv    = memoryview(self.buf)
+        self.block = self.mv[:_BLOCK]
+        self.zeros = memoryview(bytearray(MAX_RECORD))
+        self.epoch = 0
+        self.seq   = 0              # the next record's sequence number
+        self.reads = 0              # blocks read by the last recover()
+        self.recover()
+
+    # the seq of one block's record, or -1 when the block is torn, blank or from another epoch
+    def _check(self, mv, epoch:int=-1) -> int:
+        magic, length, e, seq, crc = unpack_from('<HHIII', mv, 0)
+        if magic != _MAGIC or length > MAX_RECORD or (epoch > -1 and e != epoch):
+            return -1
+        if crc32(mv[_HEADER:], crc32(mv[:12])) != crc:
+            return -1
+        return seq
+
+    def _read(self, index:int, epoch:int=-1) -> int:
+        self.sd.readblocks(self.start + index, self.block)
+        self.reads += 1
+        return self._check(self.block, epoch)
+
+    # finds the newest intact record ~ returns its seq, or -1 when the log is empty. reads about log2(count) blocks
+    def recover(self) -> int:
+        self.reads = 0
+        first = self._read(0)
+        if first < 0:
+            # block 0 is blank, or the write that started a new lap was cut ~ then the last block holds the head
+            last = self._read(self.count - 1)
+            if last < 0 or last % self.count != self.count - 1:
+                self.reset()
+                return -1
+            self.epoch = unpack_from('<I', self.block, 4)[0]
+            self.seq   = last + 1
+            return last
+
+        if first % self.count:
+            # block 0 belongs to a log laid out over another region ~ this one starts empty
+            self.reset()
+            return -1
+
+        self.epoch = unpack_from('<I', self.block, 4)[0]
+        lap = first
+
+        # blocks [0, head] were written in this lap, everything behind is an older lap, torn or blank
+        lo, hi = 0, self.count - 1
+        while lo < hi:
+            mid = (lo + hi + 1) >> 1
+            if self._read(mid, self.epoch) == lap + mid:
+                lo = mid
+            else:
+                hi = mid - 1
+
+        self.seq = lap + lo + 1
+        return lap + lo
+
+    # the oldest record still in the region
+    @property
+    def tail(self) -> int:
+        return max(0, self.seq - self.count)
+
+    # writes one record into its own block ~ returns its seq. the block is on the card before this returns when `sync` is set
+    def append(self, record) -> int:
+        n = len(record)
+        assert n <= MAX_RECORD, 'Record Too Long'
+        b   = self.block
+        seq = self.seq
+        pack_into('<HHII', b, 0, _MAGIC, n, self.epoch, seq)
+        b[_HEADER:_HEADER + n] = record
+        b[_HEADER + n:] = self.zeros[n:]
+        pack_into('<I', b, 12, crc32(b[_HEADER:], crc32(b[:12])))
+
+        self.sd.writeblocks(self.start + seq % self.count, b)
+        if self.sync:
+            self.sd.ioctl(_SYNC, 0)
+        self.seq = seq + 1
+        return seq
+
+    # (seq, record) from `seq` (or the oldest still held) up to the head ~ each record is a view that the next step refills
+    def iter_from(self, seq:int=0):
+        seq = max(seq, self.tail)
+        while seq < self.seq:
+            index = seq % self.count
+            n = min(_CHUNK, self.count - index, self.seq - seq)
+            self.sd.readblocks(self.start + index, self.mv[:n * _BLOCK])
+            for i in range(n):
+                mv = self.mv[i * _BLOCK : (i + 1) * _BLOCK]
+                if self._check(mv, self.epoch) != seq:
+                    raise OSError(5)  # EIO ~ a record behind the head went bad
+                yield seq, mv[_HEADER : _HEADER + (mv[2] | mv[3] << 8)]
+                seq += 1
+
+    # starts an empty log under a fresh random epoch ~ old blocks stop counting once the first record lands, nothing is erased
+    def reset(self) -> None:
+        self.epoch = getrandbits(32)
+        self.seq   = 0
@@ -0,0 +1,39 @@
+# Reads back a raw region written by SDObject.logger(), oldest block first.
+# `position` and `wraps` are the logger's info() at the time ~ store them somewhere of your own to read the region after a reset.
+# Works with the C SDObject (one CMD18 stream per contiguous part) and falls back to readblocks in chunks for sdcard.py.
+_BLOCK = const(0x200)
+
+# (first block, count) of the parts in write order ~ after a wrap the oldest data sits behind `position`
+def parts(start:int, count:int, position:int, wraps:int) -> list:
+    if not wraps:
+        return [(start, position)] if position else []
+    out = [(start + position, count - position)] if position < count else []
+    if position:
+        out.append((start, position))
+    return out
+
+# yields a memoryview per block ~ each one is refilled by the next step, so use or copy it first
+def scan(sd, start:int, count:int, position:int, wraps:int=0, chunk:int=8):
+    stream = getattr(sd, 'stream', None)
+    buf    = None if stream else bytearray(chunk * _BLOCK)
+    for first, n in parts(start, count, position, wraps):
+        if stream:
+            for block in stream(first, n):
+                yield block
+            continue
+        mv = memoryview(buf)
+        while n:
+            k = min(n, chunk)
+            sd.readblocks(first, mv[:k * _BLOCK])
+            for i in range(k):
+                yield mv[i * _BLOCK : (i + 1) * _BLOCK]
+            first += k
+            n     -= k
+
+# copies the region into a file in write order ~ returns the bytes written
+def save(sd, path:str, start:int, count:int, position:int, wraps:int=0) -> int:
+    total = 0
+    with open(path, 'wb') as f:
+        for block in scan(sd, start, count, position, wraps):
+            total += f.write(block)
+    return total
@@ -0,0 +1,76 @@
+# Timeline of an SDObject command trace, run on the host (CPython 3).
+# On the board: open('trace.bin', 'wb').write(sd.trace()) with the card built as SDObject(..., trace=256), then copy the file over.
+# python3 sdtrace.py trace.bin [--csv]
+import struct, sys
+
+ENTRY      = struct.Struct('<IIIHBB')   #t_us, arg, len, polls, cmd, r1 ~ sdcard_trace_entry_t
+STOP_TRAN  = 0xFD
+
+NAMES      = {0: 'GO_IDLE', 8: 'SEND_IF_COND', 9: 'SEND_CSD', 10: 'SEND_CID', 12: 'STOP', 13: 'STATUS', 16: 'BLOCKLEN',
+              17: 'READ', 18: 'READ_MULTI', 23: 'SET_COUNT', 24: 'WRITE', 25: 'WRITE_MULTI', 32: 'ERASE_START',
+              33: 'ERASE_END', 38: 'ERASE', 55: 'APP', 58: 'READ_OCR', 59: 'CRC_ON_OFF'}
+APP_NAMES  = {13: 'SD_STATUS', 23: 'PRE_ERASE', 41: 'OP_COND', 51: 'SEND_SCR'}
+
+#R1 bits from the lowest ~ 0x80 set means no response came
+R1_FLAGS   = ('idle', 'erase_reset', 'illegal', 'crc', 'erase_seq', 'address', 'param')
+
+def entries(data:bytes) -> list:
+    n = len(data) // ENTRY.size
+    return [ENTRY.unpack_from(data, i * ENTRY.size) for i in range(n)]
+
+def r1_text(r1:int) -> str:
+    if r1 & 0x80:
+        return '-'
+    flags = [name for bit, name in enumerate(R1_FLAGS) if r1 & (1 << bit)]
+    return '|'.join(flags) if flags else 'ok'
+
+def name(cmd:int, app:bool) -> str:
+    if cmd == STOP_TRAN:
+        return 'STOP_TRAN'
+    index = cmd & 0x3F
+    if app:
+        return 'ACMD{} {}'.format(index, APP_NAMES.get(index, '')).rstrip()
+    return 'CMD{} {}'.format(index, NAMES.get(index, '')).rstrip()
+
+def timeline(rows:list) -> list:
+    out  = []
+    app  = False
+    if not rows:
+        return out
+    t0   = prev = rows[0][0]
+    for t, arg, nbytes, polls, cmd, r1 in rows:
+        #t_us is the low 32 bits of the clock ~ differences survive one wrap
+        out.append({
+            'ms'    : ((t - t0) & 0xFFFFFFFF) / 1000,
+            'delta' : (t - prev) & 0xFFFFFFFF,
+            'cmd'   : name(cmd, app),
+            'arg'   : arg,
+            'r1'    : r1_text(r1),
+            'len'   : nbytes,
+            'polls' : polls,
+        })
+        app  = cmd != STOP_TRAN and (cmd & 0x3F) == 55
+        prev = t
+    return out
+
+def main() -> None:
+    args = [a for a in sys.argv[1:] if not a.startswith('--')]
+    if len(args) != 1:
+        print('usage: sdtrace.py trace.bin [--csv]', file=sys.stderr)
+        sys.exit(2)
+
+    with open(args[0], 'rb') as f:
+        rows = timeline(entries(f.read()))
+
+    if '--csv' in sys.argv:
+        print('ms,delta_us,cmd,arg,r1,len,polls')
+        for r in rows:
+            print('{ms:.3f},{delta},{cmd},0x{arg:08X},{r1},{len},{polls}'.format(**r))
+        return
+
+    print('{:>10} {:>8}  {:<22} {:>10}  {:<12} {:>7} {:>6}'.format('ms', '+us', 'command', 'arg', 'r1', 'bytes', 'polls'))
+    for r in rows:
+        print('{ms:>10.3f} {delta:>8}  {cmd:<22} 0x{arg:08X}  {r1:<12} {len:>7} {polls:>6}'.format(**r))
+
+if __name__ == '__main__':
+    main()